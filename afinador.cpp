@@ -0,0 +1,725 @@
+#include "afinador.hpp"
+#include "contexto_solver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+struct ParametroAfinacao {
+  string nome;
+  string opcao;
+  char tipo = 'r';               // 'i', 'r', 'c' ou 'o'
+  double minimo = 0, maximo = 0; // i e r
+  vector<string> valores;        // c e o
+};
+
+struct CenarioAfinacao {
+  string arquivoParametros = "parameters.txt";
+  string arquivoInstancias = "instances-list.txt";
+  long long maxExperimentos = 1000;
+  int paralelo = 0;
+  long long semente = -1;
+  int primeiroTeste = 5;
+  int cadaTeste = 1;
+  double confianca = 0.95;
+};
+
+struct CandidatoAfinacao {
+  int id = 0;
+  int pai = -1;
+  vector<double> valores; // numero (i, r) ou indice em valores (c, o)
+  double desvio = 0.5;    // fracao da faixa usada ao gerar os filhos
+  vector<double> custos;  // por bloco; NaN = ainda nao avaliado
+};
+
+// Um bloco da corrida: instancia e semente avaliadas por todos os vivos
+struct BlocoAfinacao {
+  int instancia;
+  int semente;
+};
+
+struct EstadoAfinacao {
+  CenarioAfinacao cenario;
+  vector<ParametroAfinacao> parametros;
+  vector<shared_ptr<const ContextoSolver>> instancias;
+  vector<BlocoAfinacao> blocos;
+  vector<CandidatoAfinacao> candidatos;
+  GRASPParams base; // opcoes fixas de cada avaliacao (sem saida)
+  bool verbose = true;
+  int numThreads = 0;
+  long long experimentos = 0;
+  mt19937 rng;
+};
+
+static string aparar(const string &s) {
+  size_t i = s.find_first_not_of(" \t\r\n");
+  if (i == string::npos)
+    return "";
+  size_t f = s.find_last_not_of(" \t\r\n");
+  return s.substr(i, f - i + 1);
+}
+
+static string semAspas(const string &s) {
+  string t = aparar(s);
+  if (t.size() >= 2 && (t[0] == '"' || t[0] == '\'') && t.back() == t[0])
+    return t.substr(1, t.size() - 2);
+  return t;
+}
+
+// Divide uma linha do parameters.txt: strings entre aspas e faixas entre
+// parenteses viram um token cada; '#' comeca comentario e '|' a condicao
+static vector<string> tokensParametro(const string &linha, bool &condicao) {
+  vector<string> tokens;
+  condicao = false;
+  size_t i = 0;
+  while (i < linha.size()) {
+    char c = linha[i];
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      i++;
+    } else if (c == '#') {
+      break;
+    } else if (c == '|') {
+      condicao = true;
+      break;
+    } else if (c == '"' || c == '\'') {
+      size_t f = linha.find(c, i + 1);
+      if (f == string::npos)
+        f = linha.size();
+      tokens.push_back(linha.substr(i + 1, f - i - 1));
+      i = f + 1;
+    } else if (c == '(') {
+      size_t f = linha.find(')', i);
+      if (f == string::npos)
+        f = linha.size() - 1;
+      tokens.push_back(linha.substr(i, f - i + 1));
+      i = f + 1;
+    } else {
+      size_t f = linha.find_first_of(" \t\r\n#|", i);
+      if (f == string::npos)
+        f = linha.size();
+      tokens.push_back(linha.substr(i, f - i));
+      i = f;
+    }
+  }
+  return tokens;
+}
+
+static bool lerParametros(const string &arquivo,
+                          vector<ParametroAfinacao> &parametros) {
+  ifstream entrada(arquivo);
+  if (!entrada) {
+    cerr << "Erro: Nao foi possivel abrir " << arquivo << endl;
+    return false;
+  }
+  string linha;
+  int numLinha = 0;
+  while (getline(entrada, linha)) {
+    numLinha++;
+    bool condicao;
+    vector<string> tokens = tokensParametro(linha, condicao);
+    if (tokens.empty())
+      continue;
+    if (tokens.size() < 4 || tokens[3].empty() || tokens[3][0] != '(') {
+      cerr << "Erro: " << arquivo << ":" << numLinha
+           << ": esperado nome \"--opcao=\" tipo (faixa)" << endl;
+      return false;
+    }
+    if (condicao) {
+      cerr << "Erro: " << arquivo << ":" << numLinha
+           << ": condicoes entre parametros nao sao suportadas" << endl;
+      return false;
+    }
+
+    ParametroAfinacao p;
+    p.nome = tokens[0];
+    p.opcao = tokens[1];
+    p.tipo = tokens[2][0];
+    vector<string> itens;
+    stringstream faixa(tokens[3].substr(1, tokens[3].size() - 2));
+    string item;
+    while (getline(faixa, item, ','))
+      itens.push_back(semAspas(item));
+
+    if (p.tipo == 'i' || p.tipo == 'r') {
+      if (itens.size() != 2) {
+        cerr << "Erro: " << arquivo << ":" << numLinha
+             << ": faixa numerica deve ter (minimo, maximo)" << endl;
+        return false;
+      }
+      p.minimo = atof(itens[0].c_str());
+      p.maximo = atof(itens[1].c_str());
+    } else if (p.tipo == 'c' || p.tipo == 'o') {
+      p.valores = itens;
+    } else {
+      cerr << "Erro: " << arquivo << ":" << numLinha << ": tipo '"
+           << tokens[2] << "' desconhecido (use i, r, c ou o)" << endl;
+      return false;
+    }
+    parametros.push_back(p);
+  }
+  if (parametros.empty()) {
+    cerr << "Erro: nenhum parametro em " << arquivo << endl;
+    return false;
+  }
+  return true;
+}
+
+static bool lerCenario(const string &arquivo, CenarioAfinacao &cenario) {
+  ifstream entrada(arquivo);
+  if (!entrada) {
+    cerr << "Erro: Nao foi possivel abrir " << arquivo << endl;
+    return false;
+  }
+  string linha;
+  while (getline(entrada, linha)) {
+    size_t comentario = linha.find('#');
+    if (comentario != string::npos)
+      linha = linha.substr(0, comentario);
+    size_t igual = linha.find('=');
+    if (igual == string::npos)
+      continue;
+    string chave = aparar(linha.substr(0, igual));
+    string valor = semAspas(linha.substr(igual + 1));
+    if (chave == "parameterFile")
+      cenario.arquivoParametros = valor;
+    else if (chave == "trainInstancesFile")
+      cenario.arquivoInstancias = valor;
+    else if (chave == "maxExperiments")
+      cenario.maxExperimentos = atoll(valor.c_str());
+    else if (chave == "parallel")
+      cenario.paralelo = atoi(valor.c_str());
+    else if (chave == "seed")
+      cenario.semente = atoll(valor.c_str());
+    else if (chave == "firstTest")
+      cenario.primeiroTeste = max(1, atoi(valor.c_str()));
+    else if (chave == "eachTest")
+      cenario.cadaTeste = max(1, atoi(valor.c_str()));
+    else if (chave == "confidence")
+      cenario.confianca = atof(valor.c_str());
+  }
+  return true;
+}
+
+static string textoValor(const ParametroAfinacao &p, double v) {
+  if (p.tipo == 'c' || p.tipo == 'o')
+    return p.valores[static_cast<size_t>(v)];
+  char tmp[32];
+  if (p.tipo == 'i')
+    snprintf(tmp, sizeof(tmp), "%lld", llround(v));
+  else
+    snprintf(tmp, sizeof(tmp), "%.4f", v);
+  return tmp;
+}
+
+static string linhaComando(const EstadoAfinacao &estado,
+                           const CandidatoAfinacao &c) {
+  string linha;
+  for (size_t k = 0; k < estado.parametros.size(); k++) {
+    if (!linha.empty())
+      linha += ' ';
+    linha += estado.parametros[k].opcao +
+             textoValor(estado.parametros[k], c.valores[k]);
+  }
+  return linha;
+}
+
+static GRASPParams paramsCandidato(const EstadoAfinacao &estado,
+                                   const CandidatoAfinacao &c) {
+  GRASPParams p = estado.base;
+  string erro;
+  for (size_t k = 0; k < estado.parametros.size(); k++) {
+    const ParametroAfinacao &par = estado.parametros[k];
+    aplicarOpcaoGRASP(par.opcao + textoValor(par, c.valores[k]), p, erro);
+  }
+  return p;
+}
+
+// Todas as opcoes precisam ser do GRASP e aceitar os extremos da faixa
+static bool validarParametros(const EstadoAfinacao &estado) {
+  for (const ParametroAfinacao &par : estado.parametros) {
+    vector<double> extremos;
+    if (par.tipo == 'i' || par.tipo == 'r') {
+      if (par.minimo > par.maximo) {
+        cerr << "Erro: faixa vazia para " << par.nome << endl;
+        return false;
+      }
+      extremos = {par.minimo, par.maximo};
+    } else {
+      for (size_t v = 0; v < par.valores.size(); v++)
+        extremos.push_back(static_cast<double>(v));
+    }
+    for (double v : extremos) {
+      GRASPParams p = estado.base;
+      string erro;
+      string arg = par.opcao + textoValor(par, v);
+      if (!aplicarOpcaoGRASP(arg, p, erro)) {
+        cerr << "Erro: " << par.nome << ": " << arg
+             << " nao e uma opcao do GRASP" << endl;
+        return false;
+      }
+      if (!erro.empty()) {
+        cerr << "Erro: " << par.nome << ": " << erro << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static double arredondar(const ParametroAfinacao &p, double v) {
+  if (p.tipo == 'r')
+    return round(v * 1e4) / 1e4;
+  return round(v);
+}
+
+static double amostrarUniforme(const ParametroAfinacao &p, mt19937 &rng) {
+  if (p.tipo == 'c' || p.tipo == 'o')
+    return uniform_int_distribution<int>(0, p.valores.size() - 1)(rng);
+  if (p.tipo == 'i')
+    return static_cast<double>(uniform_int_distribution<long long>(
+        llround(p.minimo), llround(p.maximo))(rng));
+  return arredondar(p, uniform_real_distribution<double>(p.minimo,
+                                                         p.maximo)(rng));
+}
+
+// Numericos e ordinais: normal truncada em torno do valor do pai.
+// Categoricos: mantem o valor do pai com probabilidade crescente ao longo
+// das iteracoes, senao sorteia.
+static double amostrarVizinho(const ParametroAfinacao &p, double valorPai,
+                              double desvio, double progresso, mt19937 &rng) {
+  if (p.tipo == 'c') {
+    if (uniform_real_distribution<double>(0, 1)(rng) < progresso)
+      return valorPai;
+    return amostrarUniforme(p, rng);
+  }
+  double minimo = p.tipo == 'o' ? 0 : p.minimo;
+  double maximo = p.tipo == 'o' ? p.valores.size() - 1 : p.maximo;
+  normal_distribution<double> normal(valorPai, desvio * (maximo - minimo));
+  double v = valorPai;
+  for (int tentativa = 0; tentativa < 20; tentativa++) {
+    double sorteado = normal(rng);
+    if (sorteado >= minimo && sorteado <= maximo) {
+      v = sorteado;
+      break;
+    }
+  }
+  return arredondar(p, min(maximo, max(minimo, v)));
+}
+
+// Ciclos embaralhados pelas instancias, cada bloco com semente propria
+static void garantirBlocos(EstadoAfinacao &estado, size_t total) {
+  while (estado.blocos.size() < total) {
+    vector<int> ordem(estado.instancias.size());
+    iota(ordem.begin(), ordem.end(), 0);
+    shuffle(ordem.begin(), ordem.end(), estado.rng);
+    for (int i : ordem) {
+      int semente = uniform_int_distribution<int>(0, 1 << 30)(estado.rng);
+      estado.blocos.push_back({i, semente});
+    }
+  }
+}
+
+// Avalia os candidatos nos blocos [de, ate) que ainda faltam. Nao executa
+// nada e retorna false se isso passar de limite experimentos.
+static bool avaliar(EstadoAfinacao &estado, const vector<int> &ids, size_t de,
+                    size_t ate, long long limite) {
+  vector<pair<int, int>> tarefas;
+  for (int id : ids) {
+    CandidatoAfinacao &c = estado.candidatos[id];
+    if (c.custos.size() < ate)
+      c.custos.resize(ate, NAN);
+    for (size_t b = de; b < ate; b++)
+      if (isnan(c.custos[b]))
+        tarefas.push_back({id, static_cast<int>(b)});
+  }
+  if (static_cast<long long>(tarefas.size()) > limite)
+    return false;
+
+  executarParalelo(tarefas.size(), estado.numThreads, [&](int k) {
+    CandidatoAfinacao &c = estado.candidatos[tarefas[k].first];
+    const BlocoAfinacao &bloco = estado.blocos[tarefas[k].second];
+    GRASPParams p = paramsCandidato(estado, c);
+    p.seed = bloco.semente;
+    ResultadoGRASP r = estado.instancias[bloco.instancia]->executarGRASP(p);
+    c.custos[tarefas[k].second] = r.custo;
+  });
+  estado.experimentos += tarefas.size();
+  return true;
+}
+
+// Q(a, x) = Gamma(a, x) / Gamma(a): serie para x < a + 1, senao fracao
+// continuada de Lentz
+static double gamaIncompletaSuperior(double a, double x) {
+  if (x <= 0)
+    return 1;
+  double fator = exp(-x + a * log(x) - lgamma(a));
+  if (x < a + 1) {
+    double termo = 1.0 / a, soma = termo, ap = a;
+    for (int k = 0; k < 1000 && fabs(termo) > fabs(soma) * 1e-15; k++) {
+      ap += 1;
+      termo *= x / ap;
+      soma += termo;
+    }
+    return max(0.0, 1 - soma * fator);
+  }
+  const double minusculo = 1e-300;
+  double b = x + 1 - a, c = 1 / minusculo, d = 1 / b, h = d;
+  for (int i = 1; i < 1000; i++) {
+    double an = -i * (i - a);
+    b += 2;
+    d = an * d + b;
+    if (fabs(d) < minusculo)
+      d = minusculo;
+    c = b + an / c;
+    if (fabs(c) < minusculo)
+      c = minusculo;
+    d = 1 / d;
+    double delta = d * c;
+    h *= delta;
+    if (fabs(delta - 1) < 1e-15)
+      break;
+  }
+  return fator * h;
+}
+
+// Quantil da normal padrao (aproximacao racional de Acklam)
+static double quantilNormal(double p) {
+  static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                             -2.759285104469687e+02, 1.383577518672690e+02,
+                             -3.066479806614716e+01, 2.506628277459239e+00};
+  static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                             -1.556989798598866e+02, 6.680131188771972e+01,
+                             -1.328068155288572e+01};
+  static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                             -2.400758277161838e+00, -2.549732539343734e+00,
+                             4.374664141464968e+00,  2.938163982698783e+00};
+  static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                             2.445134137142996e+00, 3.754408661907416e+00};
+  auto cauda = [&](double q) {
+    return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+            c[5]) /
+           ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+  };
+  if (p < 0.02425)
+    return cauda(sqrt(-2 * log(p)));
+  if (p > 1 - 0.02425)
+    return -cauda(sqrt(-2 * log(1 - p)));
+  double q = p - 0.5, r = q * q;
+  return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r +
+          a[5]) *
+         q /
+         (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// Quantil da t de Student: exato para 1 e 2 graus de liberdade, expansao
+// de Cornish-Fisher acima disso
+static double quantilT(double p, double gl) {
+  if (gl <= 1)
+    return tan(M_PI * (p - 0.5));
+  if (gl <= 2)
+    return (2 * p - 1) / sqrt(2 * p * (1 - p));
+  double z = quantilNormal(p), z2 = z * z;
+  double g1 = (z2 + 1) * z / 4;
+  double g2 = ((5 * z2 + 16) * z2 + 3) * z / 96;
+  double g3 = (((3 * z2 + 19) * z2 + 17) * z2 - 15) * z / 384;
+  double g4 =
+      ((((79 * z2 + 776) * z2 + 1482) * z2 - 1920) * z2 - 945) * z / 92160;
+  return z + g1 / gl + g2 / (gl * gl) + g3 / (gl * gl * gl) +
+         g4 / (gl * gl * gl * gl);
+}
+
+// Teste de Friedman sobre os n primeiros blocos (ranks por bloco, empates
+// com rank medio). Retorna o p-valor; critico e a diferenca minima entre
+// somas de ranks nas comparacoes de Conover (a mesma do irace).
+static double testeFriedman(const EstadoAfinacao &estado,
+                            const vector<int> &vivos, size_t n,
+                            double alfa, vector<double> &somaRanks,
+                            double &critico) {
+  size_t k = vivos.size();
+  somaRanks.assign(k, 0);
+  critico = numeric_limits<double>::infinity();
+  double somaQuadrados = 0;
+  vector<size_t> ordem(k);
+  for (size_t b = 0; b < n; b++) {
+    auto custo = [&](size_t j) { return estado.candidatos[vivos[j]].custos[b]; };
+    iota(ordem.begin(), ordem.end(), 0);
+    sort(ordem.begin(), ordem.end(),
+         [&](size_t x, size_t y) { return custo(x) < custo(y); });
+    for (size_t i = 0; i < k;) {
+      size_t f = i;
+      while (f + 1 < k && custo(ordem[f + 1]) == custo(ordem[i]))
+        f++;
+      double rank = (i + f) / 2.0 + 1;
+      for (size_t t = i; t <= f; t++) {
+        somaRanks[ordem[t]] += rank;
+        somaQuadrados += rank * rank;
+      }
+      i = f + 1;
+    }
+  }
+  if (n < 2 || k < 2)
+    return 1;
+
+  double C = n * k * (k + 1) * (k + 1) / 4.0;
+  double S = 0;
+  for (double r : somaRanks)
+    S += r * r;
+  if (somaQuadrados - C <= 1e-9)
+    return 1; // todos empatados em todos os blocos
+  double T = (k - 1) * (S - n * C) / (somaQuadrados - C);
+  double gl = (n - 1.0) * (k - 1.0);
+  critico = quantilT(1 - alfa / 2, gl) *
+            sqrt(2 * (n * somaQuadrados - S) / gl);
+  return gamaIncompletaSuperior((k - 1) / 2.0, T / 2);
+}
+
+// Uma corrida: avalia os vivos bloco a bloco e elimina os piores. Retorna
+// os sobreviventes do melhor para o pior rank.
+static vector<int> correr(EstadoAfinacao &estado, vector<int> vivos,
+                          long long orcamento, size_t minimoSobreviventes) {
+  const CenarioAfinacao &cen = estado.cenario;
+  double alfa = 1 - cen.confianca;
+  long long inicial = estado.experimentos;
+  size_t n = 0;
+  vector<double> somaRanks;
+  double critico;
+
+  while (true) {
+    size_t novos = n == 0 ? cen.primeiroTeste : cen.cadaTeste;
+    garantirBlocos(estado, n + novos);
+    long long restante = orcamento - (estado.experimentos - inicial);
+    bool avaliou = avaliar(estado, vivos, n, n + novos, restante);
+    // Primeiro passo fora do orcamento: descarta candidatos novos do fim
+    while (!avaliou && n == 0 && vivos.size() > 1) {
+      vivos.pop_back();
+      avaliou = avaliar(estado, vivos, n, n + novos, restante);
+    }
+    if (!avaliou)
+      break;
+    n += novos;
+
+    double pValor =
+        testeFriedman(estado, vivos, n, alfa, somaRanks, critico);
+    if (pValor < alfa) {
+      double melhor = *min_element(somaRanks.begin(), somaRanks.end());
+      vector<int> mantidos;
+      for (size_t j = 0; j < vivos.size(); j++)
+        if (somaRanks[j] - melhor <= critico)
+          mantidos.push_back(vivos[j]);
+      if (estado.verbose && mantidos.size() < vivos.size()) {
+        cout << "  bloco " << n << ": " << vivos.size() - mantidos.size()
+             << " eliminados (p = " << pValor << "), " << mantidos.size()
+             << " vivos" << endl;
+      }
+      vivos = mantidos;
+    }
+    if (vivos.size() <= minimoSobreviventes)
+      break;
+  }
+
+  if (n == 0)
+    return vivos;
+  testeFriedman(estado, vivos, n, alfa, somaRanks, critico);
+  vector<size_t> ordem(vivos.size());
+  iota(ordem.begin(), ordem.end(), 0);
+  stable_sort(ordem.begin(), ordem.end(),
+              [&](size_t x, size_t y) { return somaRanks[x] < somaRanks[y]; });
+  vector<int> ordenados;
+  for (size_t j : ordem)
+    ordenados.push_back(vivos[j]);
+  return ordenados;
+}
+
+static double custoMedio(const CandidatoAfinacao &c, int &avaliacoes) {
+  double soma = 0;
+  avaliacoes = 0;
+  for (double v : c.custos) {
+    if (!isnan(v)) {
+      soma += v;
+      avaliacoes++;
+    }
+  }
+  return avaliacoes > 0 ? soma / avaliacoes : NAN;
+}
+
+// Mesmo formato do configurations.txt do irace: nomes na primeira linha
+static bool gravarElites(const EstadoAfinacao &estado, const vector<int> &elites,
+                         const string &arquivo) {
+  ofstream saida(arquivo);
+  if (!saida)
+    return false;
+  saida << "## Elites da afinacao nativa (main --tune), melhor primeiro\n";
+  for (size_t k = 0; k < estado.parametros.size(); k++)
+    saida << (k ? " " : "") << estado.parametros[k].nome;
+  saida << "\n";
+  for (int id : elites) {
+    const CandidatoAfinacao &c = estado.candidatos[id];
+    for (size_t k = 0; k < estado.parametros.size(); k++) {
+      const ParametroAfinacao &p = estado.parametros[k];
+      string texto = textoValor(p, c.valores[k]);
+      if (p.tipo == 'c' || p.tipo == 'o')
+        texto = "\"" + texto + "\"";
+      saida << (k ? " " : "") << texto;
+    }
+    saida << "\n";
+  }
+  return static_cast<bool>(saida);
+}
+
+int executarAfinador(const string &diretorio, const GRASPParams &base,
+                     int numThreads) {
+  EstadoAfinacao estado;
+  estado.base = base;
+  estado.base.run_number = -1;
+  estado.base.inicio_mip.clear();
+  if (estado.base.tempo_limite < 0)
+    estado.base.tempo_limite = 30;
+  estado.verbose = base.verbose;
+  estado.base.verbose = false;
+  bool verbose = estado.verbose;
+
+  string prefixo = diretorio.empty() ? "" : diretorio + "/";
+  CenarioAfinacao &cen = estado.cenario;
+  if (!lerCenario(prefixo + "scenario.txt", cen) ||
+      !lerParametros(prefixo + cen.arquivoParametros, estado.parametros) ||
+      !validarParametros(estado))
+    return 1;
+  estado.numThreads = numThreads > 0 ? numThreads : cen.paralelo;
+  estado.rng.seed(cen.semente >= 0 ? static_cast<unsigned>(cen.semente)
+                                   : random_device{}());
+
+  ifstream lista(prefixo + cen.arquivoInstancias);
+  if (!lista) {
+    cerr << "Erro: Nao foi possivel abrir " << prefixo + cen.arquivoInstancias
+         << endl;
+    return 1;
+  }
+  string linha;
+  while (getline(lista, linha)) {
+    string nome = aparar(linha);
+    if (nome.empty() || nome[0] == '#')
+      continue;
+    auto contexto = carregarContexto(nome);
+    if (!contexto)
+      return 1;
+    estado.instancias.push_back(contexto);
+  }
+  if (estado.instancias.empty()) {
+    cerr << "Erro: nenhuma instancia em " << prefixo + cen.arquivoInstancias
+         << endl;
+    return 1;
+  }
+
+  // Orcamento por iteracao e numero de candidatos como no irace
+  size_t numParametros = estado.parametros.size();
+  int numIteracoes = 2 + static_cast<int>(log2(numParametros));
+  size_t minimoSobreviventes = 2 + static_cast<size_t>(log2(numParametros));
+
+  if (verbose) {
+    cout << "Afinacao: " << numParametros << " parametros, "
+         << estado.instancias.size() << " instancias, "
+         << cen.maxExperimentos << " experimentos, " << numIteracoes
+         << " iteracoes, tempo limite " << estado.base.tempo_limite << " s"
+         << endl;
+  }
+
+  auto inicio = chrono::steady_clock::now();
+  vector<int> elites;
+  for (int it = 1; it <= numIteracoes; it++) {
+    long long restante = cen.maxExperimentos - estado.experimentos;
+    if (restante <= 0)
+      break;
+    long long orcamento =
+        it == numIteracoes ? restante : restante / (numIteracoes - it + 1);
+    long long numCandidatos =
+        orcamento / (max(5, cen.primeiroTeste) + min(5, it));
+    long long numNovos = numCandidatos - static_cast<long long>(elites.size());
+    if (numNovos <= 0)
+      break;
+
+    // Pais sorteados com peso decrescente pelo rank da elite
+    vector<int> vivos = elites;
+    vector<double> pesos;
+    for (size_t r = 0; r < elites.size(); r++)
+      pesos.push_back(static_cast<double>(elites.size() - r));
+    double progresso = static_cast<double>(it - 1) / numIteracoes;
+    double reducao = pow(1.0 / numNovos, 1.0 / numParametros);
+    for (long long k = 0; k < numNovos; k++) {
+      CandidatoAfinacao c;
+      c.id = static_cast<int>(estado.candidatos.size());
+      if (elites.empty()) {
+        for (const ParametroAfinacao &p : estado.parametros)
+          c.valores.push_back(amostrarUniforme(p, estado.rng));
+      } else {
+        discrete_distribution<int> sorteio(pesos.begin(), pesos.end());
+        const CandidatoAfinacao &pai = estado.candidatos[elites[sorteio(estado.rng)]];
+        c.pai = pai.id;
+        c.desvio = pai.desvio * reducao;
+        for (size_t p = 0; p < numParametros; p++) {
+          c.valores.push_back(amostrarVizinho(estado.parametros[p],
+                                              pai.valores[p], c.desvio,
+                                              progresso, estado.rng));
+        }
+      }
+      estado.candidatos.push_back(c);
+      vivos.push_back(c.id);
+    }
+
+    if (verbose) {
+      cout << "Iteracao " << it << "/" << numIteracoes << ": "
+           << vivos.size() << " candidatos (" << numNovos
+           << " novos), orcamento " << orcamento << endl;
+    }
+    vector<int> sobreviventes =
+        correr(estado, vivos, orcamento, minimoSobreviventes);
+    elites.assign(sobreviventes.begin(),
+                  sobreviventes.begin() +
+                      min(sobreviventes.size(), minimoSobreviventes));
+    if (verbose && !elites.empty()) {
+      int avaliacoes;
+      const CandidatoAfinacao &melhor = estado.candidatos[elites[0]];
+      double media = custoMedio(melhor, avaliacoes);
+      cout << "  melhor: " << linhaComando(estado, melhor) << " (custo medio "
+           << media << " em " << avaliacoes << " avaliacoes)" << endl;
+    }
+  }
+  double segundos =
+      chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+  if (elites.empty()) {
+    cerr << "Erro: orcamento insuficiente para uma corrida" << endl;
+    return 1;
+  }
+
+  string arquivoElites = prefixo + "elites.txt";
+  if (!gravarElites(estado, elites, arquivoElites)) {
+    cerr << "Erro: Nao foi possivel gravar " << arquivoElites << endl;
+    return 1;
+  }
+
+  if (verbose) {
+    cout << "\n=== Elites ===" << endl;
+    for (size_t r = 0; r < elites.size(); r++) {
+      int avaliacoes;
+      const CandidatoAfinacao &c = estado.candidatos[elites[r]];
+      double media = custoMedio(c, avaliacoes);
+      cout << r + 1 << ": " << linhaComando(estado, c) << "  (custo medio "
+           << media << ", " << avaliacoes << " avaliacoes)" << endl;
+    }
+    cout << estado.experimentos << " experimentos em " << segundos << " s, "
+         << estado.candidatos.size() << " configuracoes avaliadas" << endl;
+    cout << "Elites gravadas em " << arquivoElites << endl;
+  } else {
+    cout << linhaComando(estado, estado.candidatos[elites[0]]) << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef AFINADOR_HPP
+#define AFINADOR_HPP
+
+#include "grasp_solver.hpp"
+#include <string>
+
+using namespace std;
+
+// Afinacao dos parametros do GRASP por corridas iteradas (F-Race, como o
+// irace), sem R e sem um processo por avaliacao. Usa os arquivos do
+// diretorio de tuning:
+//   scenario.txt        maxExperiments, parallel, seed, firstTest,
+//                       eachTest, confidence, parameterFile,
+//                       trainInstancesFile
+//   parameters.txt      nome "--opcao=" tipo (i, r, c ou o) (faixa)
+//   instances-list.txt  instancias de dataset/, uma por linha
+// As instancias sao carregadas uma vez e as avaliacoes rodam em paralelo.
+// A cada corrida, candidatos estatisticamente piores (teste de Friedman
+// com comparacoes de Conover) sao eliminados; os sobreviventes geram os
+// candidatos da iteracao seguinte. As elites finais vao para
+// <diretorio>/elites.txt, com os nomes de parameters.txt.
+//
+// base traz as demais opcoes do GRASP (sem --tempo-limite usa 30 s, como o
+// target-runner). numThreads <= 0 usa o parallel do cenario.
+int executarAfinador(const string &diretorio, const GRASPParams &base,
+                     int numThreads = 0);
+
+#endif
@@ -0,0 +1,372 @@
+#include "contexto_solver.hpp"
+#include "grasp_interno.hpp"
+#include "json.hpp"
+#include "utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Micro-benchmarks das pecas do GRASP. Cada medicao vira uma linha JSON
+// (bench, instancia, ops, ns_op, movimentos_s, aloc_op) para que duas
+// builds possam ser comparadas com --comparar=a.jsonl,b.jsonl.
+
+// Contagem de alocacoes: substitui o operator new global (new[] e os
+// deletes padrao delegam para estes). O GCC nao sabe que new e delete
+// foram trocados juntos e acusa o free sobre memoria de new.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static atomic<long long> alocacoes{0};
+
+void *operator new(size_t tamanho) {
+  alocacoes.fetch_add(1, memory_order_relaxed);
+  if (void *p = malloc(tamanho ? tamanho : 1))
+    return p;
+  throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static const int SEMENTE = 1;
+static const double ALPHA = 0.3;
+
+static const char *INSTANCIAS_PADRAO[] = {
+    "E-n22-k4",   "E-n30-k3",   "E-n51-k5",    "E-n76-k7",
+    "X-n214-k11", "X-n459-k26", "X-n1001-k43",
+};
+
+struct Medicao {
+  string bench;
+  string instancia;
+  long long ops = 0;
+  double nsOp = 0;
+  double movimentosS = 0;
+  double alocOp = 0;
+};
+
+// Resultado de uma chamada do corpo: operacoes feitas e movimentos de
+// melhora aplicados (0 quando nao se aplica)
+struct Contagem {
+  long long ops = 0;
+  long long movimentos = 0;
+};
+
+// Repete preparar (fora da medicao) + corpo ate somar tempoMin segundos
+// dentro do corpo
+static Medicao medir(const string &bench, const string &instancia,
+                     double tempoMin, const function<void()> &preparar,
+                     const function<Contagem()> &corpo) {
+  Medicao m;
+  m.bench = bench;
+  m.instancia = instancia;
+  long long movimentos = 0, alocs = 0;
+  double segundos = 0;
+  do {
+    preparar();
+    long long alocsAntes = alocacoes.load(memory_order_relaxed);
+    auto inicio = chrono::steady_clock::now();
+    Contagem c = corpo();
+    auto fim = chrono::steady_clock::now();
+    alocs += alocacoes.load(memory_order_relaxed) - alocsAntes;
+    segundos += chrono::duration<double>(fim - inicio).count();
+    m.ops += c.ops;
+    movimentos += c.movimentos;
+  } while (segundos < tempoMin);
+
+  if (m.ops > 0) {
+    m.nsOp = segundos * 1e9 / m.ops;
+    m.alocOp = static_cast<double>(alocs) / m.ops;
+  }
+  if (segundos > 0)
+    m.movimentosS = movimentos / segundos;
+  return m;
+}
+
+static string medicaoJSON(const Medicao &m) {
+  EscritorJSON j;
+  j.abrirObjeto();
+  j.chave("bench");
+  j.valor(m.bench);
+  j.chave("instancia");
+  j.valor(m.instancia);
+  j.chave("ops");
+  j.valor(m.ops);
+  j.chave("ns_op");
+  j.valor(m.nsOp);
+  j.chave("movimentos_s");
+  j.valor(m.movimentosS);
+  j.chave("aloc_op");
+  j.valor(m.alocOp);
+  j.fecharObjeto();
+  return j.saida;
+}
+
+static bool lerMedicao(const string &linha, Medicao &m) {
+  LeitorJSON leitor(linha);
+  if (!leitor.esperar('{'))
+    return false;
+  if (leitor.consumir('}'))
+    return true;
+  do {
+    string chave;
+    if (!leitor.lerString(chave) || !leitor.esperar(':'))
+      return false;
+    double numero;
+    if (chave == "bench") {
+      leitor.lerString(m.bench);
+    } else if (chave == "instancia") {
+      leitor.lerString(m.instancia);
+    } else if (chave == "ops") {
+      leitor.lerInteiro(m.ops);
+    } else if (chave == "ns_op" && leitor.lerNumero(numero)) {
+      m.nsOp = numero;
+    } else if (chave == "movimentos_s" && leitor.lerNumero(numero)) {
+      m.movimentosS = numero;
+    } else if (chave == "aloc_op" && leitor.lerNumero(numero)) {
+      m.alocOp = numero;
+    } else {
+      leitor.pularValor();
+    }
+    if (leitor.erro)
+      return false;
+  } while (leitor.consumir(','));
+  return leitor.esperar('}') && leitor.fim();
+}
+
+static bool lerMedicoes(const string &arquivo, vector<Medicao> &medicoes) {
+  ifstream entrada(arquivo);
+  if (!entrada) {
+    cerr << "Erro: Nao foi possivel abrir " << arquivo << endl;
+    return false;
+  }
+  string linha;
+  int numLinha = 0;
+  while (getline(entrada, linha)) {
+    numLinha++;
+    if (linha.find_first_not_of(" \t\r") == string::npos)
+      continue;
+    Medicao m;
+    if (!lerMedicao(linha, m)) {
+      cerr << "Erro: " << arquivo << ":" << numLinha << ": linha invalida"
+           << endl;
+      return false;
+    }
+    medicoes.push_back(m);
+  }
+  return true;
+}
+
+// Tabela lado a lado: razao B/A de ns/op (< 1: B mais rapida) e
+// alocacoes por operacao de cada build
+static int compararMedicoes(const string &arquivoA, const string &arquivoB) {
+  vector<Medicao> a, b;
+  if (!lerMedicoes(arquivoA, a) || !lerMedicoes(arquivoB, b))
+    return 1;
+  map<pair<string, string>, const Medicao *> porChave;
+  for (const Medicao &m : b)
+    porChave[{m.bench, m.instancia}] = &m;
+
+  printf("%-24s %-12s %14s %14s %7s %10s %10s\n", "bench", "instancia",
+         "ns/op A", "ns/op B", "B/A", "aloc/op A", "aloc/op B");
+  for (const Medicao &ma : a) {
+    auto it = porChave.find({ma.bench, ma.instancia});
+    if (it == porChave.end())
+      continue;
+    const Medicao &mb = *it->second;
+    printf("%-24s %-12s %14.1f %14.1f %7.3f %10.2f %10.2f\n",
+           ma.bench.c_str(), ma.instancia.c_str(), ma.nsOp, mb.nsOp,
+           ma.nsOp > 0 ? mb.nsOp / ma.nsOp : 0.0, ma.alocOp, mb.alocOp);
+  }
+  return 0;
+}
+
+static bool selecionado(const string &filtro, const string &bench) {
+  return filtro.empty() || bench.find(filtro) != string::npos;
+}
+
+static void medirInstancia(const ContextoSolver &contexto, double tempoMin,
+                           const string &filtro,
+                           const function<void(const Medicao &)> &emitir) {
+  const InstanciaEVRP &inst = contexto.instancia;
+  const MatrizDistancia &dist = contexto.distancias();
+  const string &nome = contexto.nome;
+  int m = inst.estacoesTotal;
+  GRASPParams padrao;
+
+  if (selecionado(filtro, "carregarInstancia")) {
+    emitir(medir("carregarInstancia", nome, tempoMin, [] {}, [&] {
+      InstanciaEVRP lida;
+      carregarInstancia(nome, lida);
+      return Contagem{1, 0};
+    }));
+  }
+
+  // Solucao de partida fixa para os demais benchmarks
+  Prazo semPrazo;
+  mt19937 rngBase(SEMENTE);
+  CacheReparo cacheBase(padrao.cache_reparo);
+  Solucao base = construirSolucao(inst, dist, ALPHA, rngBase, cacheBase,
+                                  semPrazo);
+  vector<vector<int>> rotasLimpas;
+  for (const vector<int> &rota : base.rotas)
+    rotasLimpas.push_back(removerEstacoes(inst, rota));
+
+  mt19937 rng;
+  unique_ptr<CacheReparo> cache;
+  auto reiniciar = [&] {
+    rng.seed(SEMENTE);
+    cache.reset(new CacheReparo(padrao.cache_reparo));
+  };
+
+  if (selecionado(filtro, "construirSolucao")) {
+    emitir(medir("construirSolucao", nome, tempoMin, reiniciar, [&] {
+      Solucao s = construirSolucao(inst, dist, ALPHA, rng, *cache, semPrazo);
+      return Contagem{1, 0};
+    }));
+  }
+
+  if (selecionado(filtro, "inserirEstacoesRota")) {
+    vector<vector<int>> rotas;
+    emitir(medir("inserirEstacoesRota", nome, tempoMin,
+                 [&] { rotas = rotasLimpas; },
+                 [&] {
+                   for (vector<int> &rota : rotas) {
+                     vector<bool> estacaoUsada(m, false);
+                     inserirEstacoesRota(inst, dist, rota, estacaoUsada);
+                   }
+                   return Contagem{static_cast<long long>(rotas.size()), 0};
+                 }));
+  }
+
+  if (selecionado(filtro, "encontrarMelhorEstacao")) {
+    // Todos os arcos das rotas sem estacoes, com meia bateria
+    vector<bool> estacaoUsada(m, false);
+    double energia = inst.capacidadeEnergia / 2;
+    volatile int sumidouro = 0;
+    emitir(medir("encontrarMelhorEstacao", nome, tempoMin, [] {}, [&] {
+      long long ops = 0;
+      for (const vector<int> &rota : rotasLimpas) {
+        for (size_t i = 0; i + 1 < rota.size(); i++) {
+          sumidouro = sumidouro + encontrarMelhorEstacao(
+                                      inst, dist, rota[i], rota[i + 1],
+                                      energia, estacaoUsada);
+          ops++;
+        }
+      }
+      return Contagem{ops, 0};
+    }));
+  }
+
+  // Uma descida completa por operacao; movimentos = melhoras aplicadas
+  typedef bool (*OperadorBusca)(const InstanciaEVRP &, const MatrizDistancia &,
+                                Solucao &, CacheReparo &, Prazo &);
+  const pair<const char *, OperadorBusca> operadores[] = {
+      {"buscaLocalRelocate", buscaLocalRelocate},
+      {"buscaLocal2Opt", buscaLocal2Opt},
+      {"buscaLocalExchange", buscaLocalExchange},
+  };
+  for (const auto &op : operadores) {
+    if (!selecionado(filtro, op.first))
+      continue;
+    Solucao sol;
+    emitir(medir(op.first, nome, tempoMin,
+                 [&] {
+                   sol = base;
+                   reiniciar();
+                 },
+                 [&] {
+                   long long movimentos = 0;
+                   while (op.second(inst, dist, sol, *cache, semPrazo))
+                     movimentos++;
+                   return Contagem{1, movimentos};
+                 }));
+  }
+
+  if (selecionado(filtro, "validarSolucao")) {
+    emitir(medir("validarSolucao", nome, tempoMin, [] {}, [&] {
+      validarSolucao(inst, base.rotas, dist, false);
+      return Contagem{1, 0};
+    }));
+  }
+}
+
+static void imprimirUso() {
+  cerr << "Usage: ./bench [instance ...] [--filtro=<bench>] [--tempo-min=s]"
+          " [--saida=file.jsonl]"
+       << endl;
+  cerr << "       ./bench --comparar=<a.jsonl>,<b.jsonl>" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  vector<string> instancias;
+  string filtro;
+  string arquivoSaida;
+  string comparar;
+  double tempoMin = 0.2;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--filtro=", 9) == 0) {
+      filtro = argv[i] + 9;
+    } else if (strncmp(argv[i], "--tempo-min=", 12) == 0) {
+      tempoMin = atof(argv[i] + 12);
+    } else if (strncmp(argv[i], "--saida=", 8) == 0) {
+      arquivoSaida = argv[i] + 8;
+    } else if (strncmp(argv[i], "--comparar=", 11) == 0) {
+      comparar = argv[i] + 11;
+    } else if (argv[i][0] != '-') {
+      instancias.push_back(argv[i]);
+    } else {
+      cerr << "Unknown option: " << argv[i] << endl;
+      imprimirUso();
+      return 1;
+    }
+  }
+
+  if (!comparar.empty()) {
+    size_t virgula = comparar.find(',');
+    if (virgula == string::npos) {
+      imprimirUso();
+      return 1;
+    }
+    return compararMedicoes(comparar.substr(0, virgula),
+                            comparar.substr(virgula + 1));
+  }
+
+  if (instancias.empty())
+    instancias.assign(begin(INSTANCIAS_PADRAO), end(INSTANCIAS_PADRAO));
+
+  ofstream arquivo;
+  if (!arquivoSaida.empty()) {
+    arquivo.open(arquivoSaida);
+    if (!arquivo) {
+      cerr << "Erro: Nao foi possivel gravar " << arquivoSaida << endl;
+      return 1;
+    }
+  }
+  ostream &saida = arquivoSaida.empty() ? cout : arquivo;
+
+  for (const string &nome : instancias) {
+    // Sem cache binario: nao deixa .evrpbin para tras
+    auto contexto = carregarContexto(nome, false, true);
+    if (!contexto)
+      return 1;
+    medirInstancia(*contexto, tempoMin, filtro, [&](const Medicao &m) {
+      saida << medicaoJSON(m) << endl;
+      if (!arquivoSaida.empty())
+        cerr << m.bench << " " << m.instancia << ": " << m.nsOp << " ns/op"
+             << endl;
+    });
+  }
+  return 0;
+}
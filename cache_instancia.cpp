@@ -0,0 +1,256 @@
+#include "cache_instancia.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+struct CabecalhoCache {
+  char magica[8];
+  uint32_t versao;
+  uint32_t temMatriz;
+  int64_t tamanhoFonte;
+  int64_t mtimeFonte;
+
+  double valorOtimo;
+  double consumoEnergia;
+  int32_t veiculos;
+  int32_t dimensao;
+  int32_t estacoes;
+  int32_t estacoesTotal;
+  int32_t capacidade;
+  int32_t capacidadeEnergia;
+  int32_t idDeposito;
+  int32_t numVizinhos;
+};
+
+static const char MAGICA_CACHE[8] = {'E', 'V', 'R', 'P', 'B', 'I', 'N', '\0'};
+
+// Cada bloco e gravado como <uint64 bytes><dados>, alinhado a 8 bytes para
+// que a matriz possa ser lida diretamente do mapeamento.
+static void escreverBloco(FILE *f, const void *dados, uint64_t bytes) {
+  fwrite(&bytes, sizeof(bytes), 1, f);
+  if (bytes > 0)
+    fwrite(dados, 1, bytes, f);
+  static const char zeros[8] = {0};
+  if (bytes % 8 != 0)
+    fwrite(zeros, 1, 8 - bytes % 8, f);
+}
+
+template <typename T>
+static void escreverVetor(FILE *f, const vector<T> &v) {
+  escreverBloco(f, v.data(), v.size() * sizeof(T));
+}
+
+static void escreverTexto(FILE *f, const string &s) {
+  escreverBloco(f, s.data(), s.size());
+}
+
+struct LeitorBlocos {
+  const char *atual;
+  const char *fim;
+
+  bool proximo(const char *&dados, uint64_t &bytes) {
+    if (fim - atual < (ptrdiff_t)sizeof(uint64_t))
+      return false;
+    memcpy(&bytes, atual, sizeof(bytes));
+    atual += sizeof(bytes);
+    uint64_t alinhado = (bytes + 7) / 8 * 8;
+    if ((uint64_t)(fim - atual) < alinhado)
+      return false;
+    dados = atual;
+    atual += alinhado;
+    return true;
+  }
+
+  template <typename T> bool vetor(vector<T> &v) {
+    const char *dados;
+    uint64_t bytes;
+    if (!proximo(dados, bytes) || bytes % sizeof(T) != 0)
+      return false;
+    v.resize(bytes / sizeof(T));
+    if (bytes > 0)
+      memcpy(v.data(), dados, bytes);
+    return true;
+  }
+
+  bool texto(string &s) {
+    const char *dados;
+    uint64_t bytes;
+    if (!proximo(dados, bytes))
+      return false;
+    s.assign(dados, bytes);
+    return true;
+  }
+};
+
+static bool gravarCache(const string &caminho, const InstanciaEVRP &instancia,
+                        const struct stat &fonte) {
+  const MatrizDistancia *matriz = instancia.distancias.get();
+  size_t bytesMatriz =
+      matriz ? static_cast<size_t>(matriz->tamanho) * matriz->tamanho *
+                   sizeof(double)
+             : 0;
+
+  CabecalhoCache cab;
+  memset(&cab, 0, sizeof(cab));
+  memcpy(cab.magica, MAGICA_CACHE, sizeof(cab.magica));
+  cab.versao = VERSAO_CACHE_INSTANCIA;
+  cab.temMatriz = matriz && bytesMatriz <= LIMITE_MATRIZ_CACHE;
+  cab.tamanhoFonte = fonte.st_size;
+  cab.mtimeFonte = (int64_t)fonte.st_mtim.tv_sec * 1000000000LL +
+                   fonte.st_mtim.tv_nsec;
+  cab.valorOtimo = instancia.valorOtimo;
+  cab.consumoEnergia = instancia.consumoEnergia;
+  cab.veiculos = instancia.veiculos;
+  cab.dimensao = instancia.dimensao;
+  cab.estacoes = instancia.estacoes;
+  cab.estacoesTotal = instancia.estacoesTotal;
+  cab.capacidade = instancia.capacidade;
+  cab.capacidadeEnergia = instancia.capacidadeEnergia;
+  cab.idDeposito = instancia.idDeposito;
+  cab.numVizinhos = instancia.tabelas.numVizinhos;
+
+  // Grava em arquivo temporario e renomeia: processos concorrentes nunca
+  // enxergam um cache parcial
+  string temporario = caminho + ".tmp." + to_string(getpid());
+  FILE *f = fopen(temporario.c_str(), "wb");
+  if (!f)
+    return false;
+
+  escreverBloco(f, &cab, sizeof(cab));
+  escreverTexto(f, instancia.nome);
+  escreverTexto(f, instancia.comentario);
+  escreverTexto(f, instancia.tipo);
+  escreverTexto(f, instancia.formatoBorda);
+  escreverVetor(f, instancia.nos);
+  escreverVetor(f, instancia.demandas);
+  escreverVetor(f, instancia.idEstacoes);
+  escreverVetor(f, instancia.tabelas.posicaoNo);
+  escreverVetor(f, instancia.tabelas.demanda);
+  escreverVetor(f, instancia.tabelas.recarga);
+  escreverVetor(f, instancia.tabelas.vizinhos);
+  escreverBloco(f, cab.temMatriz ? matriz->dados : nullptr,
+                cab.temMatriz ? bytesMatriz : 0);
+
+  bool ok = !ferror(f);
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(temporario.c_str(), caminho.c_str()) != 0) {
+    remove(temporario.c_str());
+    return false;
+  }
+  return true;
+}
+
+static bool lerCache(const string &caminho, const struct stat &fonte,
+                     InstanciaEVRP &instancia) {
+  int fd = open(caminho.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(CabecalhoCache)) {
+    close(fd);
+    return false;
+  }
+
+  size_t tamanho = info.st_size;
+  void *mapa = mmap(nullptr, tamanho, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapa == MAP_FAILED)
+    return false;
+  shared_ptr<const void> mapeamento(
+      mapa, [tamanho](const void *p) { munmap(const_cast<void *>(p), tamanho); });
+
+  LeitorBlocos leitor{static_cast<const char *>(mapa),
+                      static_cast<const char *>(mapa) + tamanho};
+  const char *dados;
+  uint64_t bytes;
+  if (!leitor.proximo(dados, bytes) || bytes != sizeof(CabecalhoCache))
+    return false;
+
+  CabecalhoCache cab;
+  memcpy(&cab, dados, sizeof(cab));
+  int64_t mtimeFonte = (int64_t)fonte.st_mtim.tv_sec * 1000000000LL +
+                       fonte.st_mtim.tv_nsec;
+  if (memcmp(cab.magica, MAGICA_CACHE, sizeof(cab.magica)) != 0 ||
+      cab.versao != VERSAO_CACHE_INSTANCIA ||
+      cab.tamanhoFonte != fonte.st_size || cab.mtimeFonte != mtimeFonte)
+    return false;
+
+  InstanciaEVRP lida;
+  lida.valorOtimo = cab.valorOtimo;
+  lida.consumoEnergia = cab.consumoEnergia;
+  lida.veiculos = cab.veiculos;
+  lida.dimensao = cab.dimensao;
+  lida.estacoes = cab.estacoes;
+  lida.estacoesTotal = cab.estacoesTotal;
+  lida.capacidade = cab.capacidade;
+  lida.capacidadeEnergia = cab.capacidadeEnergia;
+  lida.idDeposito = cab.idDeposito;
+  lida.tabelas.numVizinhos = cab.numVizinhos;
+
+  if (!leitor.texto(lida.nome) || !leitor.texto(lida.comentario) ||
+      !leitor.texto(lida.tipo) || !leitor.texto(lida.formatoBorda) ||
+      !leitor.vetor(lida.nos) || !leitor.vetor(lida.demandas) ||
+      !leitor.vetor(lida.idEstacoes) ||
+      !leitor.vetor(lida.tabelas.posicaoNo) ||
+      !leitor.vetor(lida.tabelas.demanda) ||
+      !leitor.vetor(lida.tabelas.recarga) ||
+      !leitor.vetor(lida.tabelas.vizinhos) || !leitor.proximo(dados, bytes))
+    return false;
+
+  int totalNos = lida.dimensao + lida.estacoesTotal;
+  if (cab.temMatriz) {
+    if (bytes != static_cast<uint64_t>(totalNos) * totalNos * sizeof(double))
+      return false;
+    auto matriz = make_shared<MatrizDistancia>();
+    matriz->tamanho = totalNos;
+    matriz->dados = reinterpret_cast<const double *>(dados);
+    matriz->mapeamento = mapeamento;
+    lida.distancias = matriz;
+  } else {
+    auto matriz = make_shared<MatrizDistancia>();
+    construirMatrizDistancia(lida, *matriz);
+    lida.distancias = matriz;
+  }
+
+  instancia = move(lida);
+  return true;
+}
+
+bool carregarInstanciaCache(const string &nomeArquivo, InstanciaEVRP &instancia,
+                            bool verbose) {
+  string caminhoFonte = "dataset/" + nomeArquivo + ".evrp";
+  string caminhoCache = "dataset/" + nomeArquivo + ".evrpbin";
+
+  struct stat fonte;
+  if (stat(caminhoFonte.c_str(), &fonte) != 0) {
+    cerr << "Erro: Nao foi possivel abrir o arquivo " << caminhoFonte << endl;
+    return false;
+  }
+
+  if (lerCache(caminhoCache, fonte, instancia))
+    return true;
+
+  if (!carregarInstancia(nomeArquivo, instancia))
+    return false;
+  prepararInstancia(instancia, true);
+
+  if (gravarCache(caminhoCache, instancia, fonte)) {
+    // Recarrega pelo mapeamento para compartilhar a matriz com os demais
+    // processos desde a primeira execucao
+    InstanciaEVRP mapeada;
+    if (lerCache(caminhoCache, fonte, mapeada))
+      instancia = move(mapeada);
+  } else if (verbose) {
+    cerr << "Aviso: nao foi possivel gravar o cache " << caminhoCache << endl;
+  }
+  return true;
+}
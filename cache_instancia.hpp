@@ -0,0 +1,20 @@
+#ifndef CACHE_INSTANCIA_HPP
+#define CACHE_INSTANCIA_HPP
+
+#include "utils.hpp"
+#include <string>
+
+using namespace std;
+
+// Cache binario pre-processado de uma instancia (dataset/<nome>.evrpbin):
+// escalares, nos, demandas, estacoes, tabelas por indice, vizinhos e, se
+// couber em LIMITE_MATRIZ_CACHE, a matriz de distancias. O arquivo e criado
+// na primeira carga e depois mapeado somente leitura, entao execucoes
+// paralelas sobre a mesma instancia compartilham a matriz.
+const unsigned int VERSAO_CACHE_INSTANCIA = 1;
+const size_t LIMITE_MATRIZ_CACHE = size_t(256) << 20;
+
+bool carregarInstanciaCache(const string &nomeArquivo, InstanciaEVRP &instancia,
+                            bool verbose = true);
+
+#endif
@@ -0,0 +1,229 @@
+// Cliente do modo servidor com a interface de target-runner do irace:
+//   cliente <config_id> <instance_id> <seed> <instancia> [--param=valor ...]
+// Envia um pedido JSON ao servidor (main --serve=<socket>) e imprime so o
+// custo. Se nenhum servidor estiver escutando, inicia um a partir do
+// diretorio do executavel, que encerra sozinho depois de ficar ocioso.
+#include "json.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+const double TEMPO_LIMITE_PADRAO = 30;
+const int OCIOSO_SERVIDOR = 300; // segundos sem conexoes ate o servidor sair
+
+static void erro(const string &mensagem) {
+  cerr << "cliente: erro: " << mensagem << endl;
+  exit(1);
+}
+
+static string enderecoPadrao() {
+  const char *env = getenv("EVRP_SOCKET");
+  if (env && *env)
+    return env;
+  return "/tmp/evrp-grasp-" + to_string(getuid()) + ".sock";
+}
+
+static int conectar(const string &endereco) {
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (endereco.size() >= sizeof(addr.sun_path))
+    erro("caminho do socket muito longo: " + endereco);
+  strcpy(addr.sun_path, endereco.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Diretorio do projeto: o do proprio executavel, onde tambem fica o main
+static string diretorioProjeto() {
+  char caminho[4096];
+  ssize_t tam = readlink("/proc/self/exe", caminho, sizeof(caminho) - 1);
+  if (tam <= 0)
+    return ".";
+  string dir(caminho, tam);
+  size_t barra = dir.rfind('/');
+  return barra == string::npos ? "." : dir.substr(0, barra);
+}
+
+// lock: descritor do lock de inicializacao, fechado no filho para que o
+// servidor nao o herde (o flock duraria enquanto ele existisse)
+static void iniciarServidor(const string &endereco, int lock) {
+  string dir = diretorioProjeto();
+  string exe = dir + "/main";
+  if (access(exe.c_str(), X_OK) != 0)
+    erro(exe + ": nao encontrado ou nao executavel");
+
+  pid_t pid = fork();
+  if (pid < 0)
+    erro("fork: " + string(strerror(errno)));
+  if (pid == 0) {
+    if (lock >= 0)
+      close(lock);
+    setsid();
+    if (chdir(dir.c_str()) != 0)
+      _exit(1);
+    int nulo = open("/dev/null", O_RDWR);
+    dup2(nulo, 0);
+    dup2(nulo, 1);
+    string log = endereco + ".log";
+    int saidaErro = open(log.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    dup2(saidaErro >= 0 ? saidaErro : nulo, 2);
+    string argServe = "--serve=" + endereco;
+    string argOcioso = "--serve-ocioso=" + to_string(OCIOSO_SERVIDOR);
+    execl(exe.c_str(), "main", argServe.c_str(), argOcioso.c_str(),
+          (char *)nullptr);
+    _exit(1);
+  }
+}
+
+// Conecta ao servidor, iniciando-o se preciso. O lock evita que varias
+// avaliacoes paralelas iniciem servidores ao mesmo tempo.
+static int obterConexao(const string &endereco) {
+  int fd = conectar(endereco);
+  if (fd >= 0)
+    return fd;
+
+  string caminhoLock = endereco + ".lock";
+  int lock = open(caminhoLock.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (lock >= 0)
+    flock(lock, LOCK_EX);
+  fd = conectar(endereco);
+  if (fd < 0) {
+    iniciarServidor(endereco, lock);
+    auto limite = chrono::steady_clock::now() + chrono::seconds(30);
+    while (fd < 0 && chrono::steady_clock::now() < limite) {
+      this_thread::sleep_for(chrono::milliseconds(20));
+      fd = conectar(endereco);
+    }
+  }
+  if (lock >= 0) {
+    flock(lock, LOCK_UN);
+    close(lock);
+  }
+  if (fd < 0)
+    erro("nao foi possivel conectar ao servidor em " + endereco);
+  return fd;
+}
+
+// "--max-iter=100" -> chave "max_iter", valor numerico quando possivel
+static void adicionarParametro(EscritorJSON &j, const string &arg) {
+  if (arg == "--sem-filtro-duplicatas") {
+    j.chave("filtro_duplicatas");
+    j.valor(false);
+    return;
+  }
+  size_t igual = arg.find('=');
+  if (arg.rfind("--", 0) != 0 || igual == string::npos)
+    erro("parametro invalido: " + arg);
+  string chave = arg.substr(2, igual - 2);
+  for (char &c : chave)
+    if (c == '-')
+      c = '_';
+  if (chave == "target")
+    chave = "alvo";
+  string valor = arg.substr(igual + 1);
+
+  j.chave(chave);
+  char *fim = nullptr;
+  double numero = strtod(valor.c_str(), &fim);
+  if (!valor.empty() && fim && *fim == '\0')
+    j.valor(numero);
+  else
+    j.valor(valor);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 5) {
+    cerr << "Uso: " << argv[0]
+         << " <config_id> <instance_id> <seed> <instancia> [--param=valor ...]"
+         << endl;
+    return 1;
+  }
+
+  bool temTempoLimite = false;
+  EscritorJSON pedido;
+  pedido.abrirObjeto();
+  pedido.chave("id");
+  pedido.valor(string(argv[1]) + "-" + argv[2] + "-" + argv[3]);
+  pedido.chave("instancia");
+  pedido.valor(argv[4]);
+  pedido.chave("seed");
+  pedido.valor(atoll(argv[3]));
+  for (int i = 5; i < argc; i++) {
+    string arg = argv[i];
+    if (arg.rfind("--tempo-limite=", 0) == 0)
+      temTempoLimite = true;
+    adicionarParametro(pedido, arg);
+  }
+  if (!temTempoLimite) {
+    pedido.chave("tempo_limite");
+    pedido.valor(TEMPO_LIMITE_PADRAO);
+  }
+  pedido.fecharObjeto();
+  pedido.saida += '\n';
+
+  int fd = obterConexao(enderecoPadrao());
+  size_t enviados = 0;
+  while (enviados < pedido.saida.size()) {
+    ssize_t r = send(fd, pedido.saida.data() + enviados,
+                     pedido.saida.size() - enviados, MSG_NOSIGNAL);
+    if (r <= 0)
+      erro("falha ao enviar o pedido");
+    enviados += r;
+  }
+
+  string resposta;
+  char bloco[4096];
+  while (resposta.find('\n') == string::npos) {
+    ssize_t lidos = read(fd, bloco, sizeof(bloco));
+    if (lidos <= 0)
+      erro("conexao encerrada sem resposta");
+    resposta.append(bloco, lidos);
+  }
+  close(fd);
+
+  LeitorJSON j(resposta);
+  bool ok = false;
+  double custo = 0;
+  string mensagem, chave;
+  if (j.esperar('{') && !j.consumir('}')) {
+    do {
+      if (!j.lerString(chave) || !j.esperar(':'))
+        break;
+      if (chave == "ok")
+        j.lerBooleano(ok);
+      else if (chave == "custo")
+        j.lerNumero(custo);
+      else if (chave == "erro")
+        j.lerString(mensagem);
+      else
+        j.pularValor();
+    } while (!j.erro && j.consumir(','));
+  }
+  if (j.erro)
+    erro("resposta invalida: " + resposta);
+  if (!ok)
+    erro(mensagem);
+
+  printf("%.6f\n", custo);
+  return 0;
+}
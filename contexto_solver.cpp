@@ -0,0 +1,58 @@
+#include "contexto_solver.hpp"
+#include "cache_instancia.hpp"
+
+using namespace std;
+
+ResultadoGRASP ContextoSolver::executarGRASP(const GRASPParams &params) const {
+  return ::executarGRASP(instancia, params, nome);
+}
+
+double ContextoSolver::resolverGRASP(const GRASPParams &params) const {
+  return resolverEVRPGRASP(instancia, nome, params);
+}
+
+string ContextoSolver::gravarResultado(const GRASPParams &params,
+                                       const ResultadoGRASP &resultado) const {
+  return gravarResultadoGRASP(instancia, nome, params, resultado);
+}
+
+bool ContextoSolver::validar(const vector<vector<int>> &rotas, bool verbose,
+                             double *custo) const {
+  return validarSolucao(instancia, rotas, verbose, custo);
+}
+
+string ContextoSolver::exportarModelo(const OpcoesLP &opcoes) const {
+  return exportEVRPtoLP(instancia, "lp/" + nome, opcoes);
+}
+
+shared_ptr<const ContextoSolver> carregarContexto(const string &nomeArquivo,
+                                                  bool usarCache,
+                                                  bool comMatriz,
+                                                  bool verbose) {
+  auto contexto = make_shared<ContextoSolver>();
+  contexto->nome = nomeBaseInstancia(nomeArquivo);
+  InstanciaEVRP &instancia = contexto->instancia;
+  if (usarCache) {
+    if (!carregarInstanciaCache(contexto->nome, instancia, verbose))
+      return nullptr;
+  } else {
+    if (!carregarInstancia(contexto->nome, instancia))
+      return nullptr;
+    prepararInstancia(instancia, comMatriz);
+  }
+  contexto->hash = hashInstancia(instancia);
+  return contexto;
+}
+
+shared_ptr<const ContextoSolver>
+CatalogoContextos::obter(const string &nomeArquivo) {
+  string nome = nomeBaseInstancia(nomeArquivo);
+  lock_guard<mutex> guarda(trava);
+  auto it = contextos.find(nome);
+  if (it != contextos.end())
+    return it->second;
+  auto contexto = carregarContexto(nome, usarCache, comMatriz);
+  if (contexto)
+    contextos[nome] = contexto;
+  return contexto;
+}
@@ -0,0 +1,65 @@
+#ifndef CONTEXTO_SOLVER_HPP
+#define CONTEXTO_SOLVER_HPP
+
+#include "grasp_solver.hpp"
+#include "utils.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Instancia pronta para uso repetido: carregada uma vez, com tabelas por
+// indice, vizinhos, hash e (se pedida) a matriz de distancias. E imutavel
+// depois de carregada, entao um shared_ptr<const ContextoSolver> pode ser
+// usado por varias threads ao mesmo tempo (execucoes do GRASP, validacoes,
+// exportacao do modelo). Ponto de entrada comum de main, verify, servidor,
+// afinador e experimentos.
+struct ContextoSolver {
+  string nome; // nome base da instancia (sem dataset/ e .evrp)
+  InstanciaEVRP instancia;
+  uint64_t hash = 0;
+
+  bool temMatriz() const { return instancia.distancias != nullptr; }
+  const MatrizDistancia &distancias() const { return *instancia.distancias; }
+
+  ResultadoGRASP executarGRASP(const GRASPParams &params) const;
+  // Como --grasp: executa, grava em solucoes/ e imprime o resumo
+  double resolverGRASP(const GRASPParams &params) const;
+  string gravarResultado(const GRASPParams &params,
+                         const ResultadoGRASP &resultado) const;
+
+  // Pela matriz quando houver, senao pelas coordenadas dos arcos usados
+  bool validar(const vector<vector<int>> &rotas, bool verbose = false,
+               double *custo = nullptr) const;
+  // Exporta o modelo para lp/<nome>.<formato>; retorna o caminho
+  string exportarModelo(const OpcoesLP &opcoes = OpcoesLP()) const;
+};
+
+// usarCache: pelo cache binario (dataset/<nome>.evrpbin), que sempre traz
+// a matriz; sem cache, a matriz so e construida se comMatriz (verify
+// dispensa a matriz em instancias grandes). nullptr em caso de erro.
+shared_ptr<const ContextoSolver> carregarContexto(const string &nomeArquivo,
+                                                  bool usarCache = true,
+                                                  bool comMatriz = true,
+                                                  bool verbose = false);
+
+// Contextos carregados sob demanda e mantidos enquanto o catalogo existir;
+// seguro para varias threads
+class CatalogoContextos {
+public:
+  explicit CatalogoContextos(bool usarCache = true, bool comMatriz = true)
+      : usarCache(usarCache), comMatriz(comMatriz) {}
+
+  shared_ptr<const ContextoSolver> obter(const string &nomeArquivo);
+
+private:
+  bool usarCache;
+  bool comMatriz;
+  mutex trava;
+  map<string, shared_ptr<const ContextoSolver>> contextos;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "cplex_solver.hpp"
+#include "progresso.hpp"
 #include <cmath>
 #include <cstdio>
 #include <fstream>
@@ -11,21 +12,37 @@
 
 using namespace std;
 
-void resolverEVRP(const InstanciaEVRP &instancia, const string &nomeArquivo) {
+// Callback generico no contexto de progresso global (nao desliga a busca
+// dinamica): repassa incumbente, limite e nos ao arquivo de status
+class CallbackProgresso : public IloCplex::Callback::Function {
+public:
+  explicit CallbackProgresso(RegistroProgresso &registro)
+      : registro(registro) {}
+
+  void invoke(const IloCplex::Callback::Context &contexto) override {
+    if (!contexto.inGlobalProgress())
+      return;
+    registro.incumbente(contexto.getDoubleInfo(
+        IloCplex::Callback::Context::Info::BestSolution));
+    registro.limite(contexto.getDoubleInfo(
+        IloCplex::Callback::Context::Info::BestBound));
+    registro.iteracoes(contexto.getLongInfo(
+        IloCplex::Callback::Context::Info::NodeCount));
+  }
+
+private:
+  RegistroProgresso &registro;
+};
+
+void resolverEVRP(const ContextoSolver &contexto, const OpcoesLP &opcoes) {
+  const InstanciaEVRP &instancia = contexto.instancia;
+  const string &nomeBase = contexto.nome;
   imprimirInstanciaEVRP(instancia);
 
-  string nomeBase = nomeArquivo;
-  size_t posSlash = nomeBase.rfind('/');
-  if (posSlash != string::npos) {
-    nomeBase = nomeBase.substr(posSlash + 1);
+  string lpFilename = contexto.exportarModelo(opcoes);
+  if (lpFilename.empty()) {
+    return;
   }
-  size_t posExt = nomeBase.find(".evrp");
-  if (posExt != string::npos) {
-    nomeBase = nomeBase.substr(0, posExt);
-  }
-
-  string lpFilename = "lp/" + nomeBase + ".lp";
-  exportEVRPtoLP(instancia, "lp/" + nomeBase);
 
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
@@ -75,11 +92,23 @@ void resolverEVRP(const InstanciaEVRP &instancia, const string &nomeArquivo) {
     cplex.importModel(model, lpFilename.c_str(), obj, vars, rngs);
     cplex.extract(model);
 
+    if (!opcoes.inicioMIP.empty()) {
+      cout << "Lendo inicio MIP: " << opcoes.inicioMIP << endl;
+      cplex.readMIPStarts(opcoes.inicioMIP.c_str());
+    }
+
     cplex.setParam(IloCplex::Param::TimeLimit, 3600.0);
     cplex.setParam(IloCplex::Param::MIP::Tolerances::MIPGap, 0.0);
 
     cout << "\nIniciando otimizacao com CPLEX..." << endl;
 
+    RegistroProgresso progresso(nomeBase, "cplex");
+    CallbackProgresso callbackProgresso(progresso);
+    if (progresso.ativo()) {
+      cplex.use(&callbackProgresso,
+                IloCplex::Callback::Context::Id::GlobalProgress);
+    }
+
     double tempoInicio = cplex.getCplexTime();
     bool solved = cplex.solve();
     double tempoTotal = cplex.getCplexTime() - tempoInicio;
@@ -1,8 +1,10 @@
 #ifndef CPLEX_SOLVER_HPP
 #define CPLEX_SOLVER_HPP
 
-#include "utils.hpp"
+#include "contexto_solver.hpp"
 
-void resolverEVRP(const InstanciaEVRP &instancia, const string &nomeArquivo);
+// Exporta o modelo pelo contexto (lp/<nome>.<formato>) e o resolve
+void resolverEVRP(const ContextoSolver &contexto,
+                  const OpcoesLP &opcoes = OpcoesLP());
 
 #endif
@@ -0,0 +1,696 @@
+#include "experimento.hpp"
+#include "contexto_solver.hpp"
+#include "grasp_interno.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+using namespace std;
+
+struct TrabalhoExperimento {
+  int instancia;
+  int semente;
+  double estimativa;
+  double custo = NAN;
+  double tempo = 0;
+  double tempoMelhor = 0;
+  EstatisticasGRASP estatisticas;
+
+  TrabalhoExperimento(int instancia, int semente, double estimativa)
+      : instancia(instancia), semente(semente), estimativa(estimativa) {}
+};
+
+static string aparar(const string &s) {
+  size_t i = s.find_first_not_of(" \t\r\n");
+  if (i == string::npos)
+    return "";
+  size_t f = s.find_last_not_of(" \t\r\n");
+  return s.substr(i, f - i + 1);
+}
+
+static bool lerListaInstancias(const string &lista, vector<string> &nomes) {
+  ifstream arquivo(lista);
+  string item;
+  if (arquivo) {
+    while (getline(arquivo, item)) {
+      item = aparar(item);
+      if (!item.empty() && item[0] != '#')
+        nomes.push_back(nomeBaseInstancia(item));
+    }
+  } else {
+    stringstream ss(lista);
+    while (getline(ss, item, ','))
+      if (!aparar(item).empty())
+        nomes.push_back(nomeBaseInstancia(aparar(item)));
+  }
+  return !nomes.empty();
+}
+
+static bool lerSementes(const string &texto, vector<int> &sementes) {
+  stringstream ss(texto);
+  string item;
+  while (getline(ss, item, ',')) {
+    item = aparar(item);
+    if (item.empty())
+      continue;
+    size_t traco = item.find('-', 1);
+    char *fim;
+    long de = strtol(item.c_str(), &fim, 10);
+    long ate = de;
+    if (traco != string::npos) {
+      if (fim != item.c_str() + traco)
+        return false;
+      ate = strtol(item.c_str() + traco + 1, &fim, 10);
+    }
+    if (*fim != '\0' || de < 0 || ate < de)
+      return false;
+    for (long s = de; s <= ate; s++)
+      sementes.push_back(static_cast<int>(s));
+  }
+  return !sementes.empty();
+}
+
+// Numeros como no resultados_grasp.csv: 6 casas, sem o zero antes do
+// ponto (".317200") e, se inteiroSemCasas, inteiros sem casas ("0", "300")
+static string numeroCSV(double v, bool inteiroSemCasas) {
+  char tmp[64];
+  snprintf(tmp, sizeof(tmp), "%.6f", v);
+  string s = tmp;
+  if (inteiroSemCasas && s.compare(s.size() - 7, 7, ".000000") == 0)
+    s.resize(s.size() - 7);
+  if (s == "-0")
+    s = "0";
+  if (s.compare(0, 2, "0.") == 0)
+    s.erase(0, 1);
+  else if (s.compare(0, 3, "-0.") == 0)
+    s.erase(1, 1);
+  return s;
+}
+
+static bool gravarCSV(const string &arquivo, const vector<string> &nomes,
+                      const vector<TrabalhoExperimento> &trabalhos) {
+  ofstream csv(arquivo);
+  if (!csv)
+    return false;
+  csv << "Instância,Melhor FO,FO Média,Desvio (%),Tempo Médio (seg.),"
+         "T. Melhor (seg.)\n";
+
+  double soma[5] = {0, 0, 0, 0, 0};
+  int linhas = 0;
+  for (size_t i = 0; i < nomes.size(); i++) {
+    double melhor = INFINITY, somaFO = 0, somaTempo = 0, somaTMelhor = 0;
+    int execucoes = 0;
+    for (const TrabalhoExperimento &t : trabalhos) {
+      if (t.instancia != static_cast<int>(i) || isnan(t.custo))
+        continue;
+      melhor = min(melhor, t.custo);
+      somaFO += t.custo;
+      somaTempo += t.tempo;
+      somaTMelhor += t.tempoMelhor;
+      execucoes++;
+    }
+    if (execucoes == 0)
+      continue;
+    double media = somaFO / execucoes;
+    // Desvio da media em relacao a melhor, truncado em 4 casas
+    double desvio = floor((media - melhor) / melhor * 100 * 1e4 + 1e-9) / 1e4;
+    double valores[5] = {melhor, media, desvio, somaTempo / execucoes,
+                         somaTMelhor / execucoes};
+    csv << nomes[i];
+    for (int c = 0; c < 5; c++) {
+      csv << "," << numeroCSV(valores[c], c >= 2);
+      soma[c] += valores[c];
+    }
+    csv << "\n";
+    linhas++;
+  }
+  if (linhas > 0) {
+    csv << "MÉDIA";
+    for (int c = 0; c < 5; c++)
+      csv << "," << numeroCSV(soma[c] / linhas, false);
+    csv << "\n";
+  }
+  return static_cast<bool>(csv);
+}
+
+int executarExperimento(const string &lista, const string &sementes,
+                        const GRASPParams &base, const string &arquivoCSV,
+                        int numThreads) {
+  vector<string> nomes;
+  vector<int> valoresSementes;
+  if (!lerListaInstancias(lista, nomes)) {
+    cerr << "Erro: nenhuma instancia em " << lista << endl;
+    return 1;
+  }
+  if (!lerSementes(sementes, valoresSementes)) {
+    cerr << "Erro: sementes invalidas: " << sementes << endl;
+    return 1;
+  }
+
+  vector<shared_ptr<const ContextoSolver>> contextos;
+  for (const string &nome : nomes) {
+    auto contexto = carregarContexto(nome);
+    if (!contexto)
+      return 1;
+    contextos.push_back(contexto);
+  }
+
+  // LPT: custo de uma iteracao cresce com o quadrado do numero de nos
+  vector<TrabalhoExperimento> trabalhos;
+  for (size_t i = 0; i < nomes.size(); i++) {
+    const InstanciaEVRP &inst = contextos[i]->instancia;
+    double nos = inst.dimensao + inst.estacoes;
+    for (int s : valoresSementes)
+      trabalhos.emplace_back(static_cast<int>(i), s, nos * nos);
+  }
+  stable_sort(trabalhos.begin(), trabalhos.end(),
+              [](const TrabalhoExperimento &a, const TrabalhoExperimento &b) {
+                return a.estimativa > b.estimativa;
+              });
+
+  bool verbose = base.verbose;
+  if (verbose) {
+    cout << "Experimento: " << nomes.size() << " instancias x "
+         << valoresSementes.size() << " sementes = " << trabalhos.size()
+         << " execucoes" << endl;
+  }
+
+  mutex mutexSaida;
+  int concluidos = 0;
+  bool falhou = false;
+  auto inicio = chrono::steady_clock::now();
+  executarParalelo(trabalhos.size(), numThreads, [&](int k) {
+    TrabalhoExperimento &t = trabalhos[k];
+    GRASPParams p = base;
+    p.verbose = false;
+    p.seed = t.semente;
+    p.run_number = -1;
+    p.inicio_mip.clear();
+    const ContextoSolver &contexto = *contextos[t.instancia];
+    ResultadoGRASP r = contexto.executarGRASP(p);
+    t.custo = r.custo;
+    t.tempo = r.tempo;
+    t.tempoMelhor = r.tempoMelhor;
+    t.estatisticas = r.estatisticas;
+    string arquivo = contexto.gravarResultado(p, r);
+    bool convergenciaGravada =
+        p.convergencia.empty() ||
+        gravarConvergencia(p.convergencia, contexto.nome, r);
+
+    lock_guard<mutex> trava(mutexSaida);
+    concluidos++;
+    if (arquivo.empty() || !convergenciaGravada)
+      falhou = true;
+    if (verbose) {
+      cout << "[" << concluidos << "/" << trabalhos.size() << "] "
+           << nomes[t.instancia] << " seed " << t.semente << ": " << fixed
+           << setprecision(6) << r.custo << " (" << r.tempoMelhor << " / "
+           << r.tempo << " s)" << endl;
+    }
+  });
+  double segundos =
+      chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+  if (!gravarCSV(arquivoCSV, nomes, trabalhos)) {
+    cerr << "Erro: Nao foi possivel gravar " << arquivoCSV << endl;
+    return 1;
+  }
+
+  // Estatisticas por instancia, somadas sobre as sementes
+  if (!base.estatisticas.empty()) {
+    for (size_t i = 0; i < nomes.size(); i++) {
+      EstatisticasGRASP soma;
+      int execucoes = 0;
+      double tempo = 0;
+      for (const TrabalhoExperimento &t : trabalhos) {
+        if (t.instancia != static_cast<int>(i))
+          continue;
+        soma.somar(t.estatisticas);
+        tempo += t.tempo;
+        execucoes++;
+      }
+      if (!emitirEstatisticas(base.estatisticas, nomes[i], -1, execucoes,
+                              tempo, soma)) {
+        cerr << "Erro: Nao foi possivel gravar " << base.estatisticas << endl;
+        return 1;
+      }
+    }
+  }
+  if (verbose) {
+    cout << "Resumo gravado em " << arquivoCSV << " (" << segundos << " s)"
+         << endl;
+  }
+  return falhou ? 1 : 0;
+}
+
+// Conjunto fixo da regressao: instancias pequenas o bastante para rodar em
+// segundos, cada uma com seu orcamento de avaliacoes por execucao
+struct CasoRegressao {
+  const char *instancia;
+  long long orcamento;
+};
+
+static const CasoRegressao CASOS_REGRESSAO[] = {
+    {"E-n22-k4", 50000},  {"E-n30-k3", 100000}, {"E-n33-k4", 100000},
+    {"E-n51-k5", 200000}, {"E-n76-k7", 400000},
+};
+static const char *SEMENTES_REGRESSAO = "1-5";
+
+// Uma linha de regressao_grasp.csv. Alvo: FO Media da base quando ela foi
+// gravada; Aval. Alvo: media de avaliacoes ate alcanca-lo (execucoes que nao
+// alcancam contam o orcamento gasto inteiro)
+struct LinhaRegressao {
+  string instancia;
+  string sementes;
+  long long orcamento = 0;
+  double alvo = 0;
+  double melhor = 0;
+  double media = 0;
+  double avalAlvo = 0;
+  double taxaAlvo = 0;
+};
+
+static const char *CABECALHO_REGRESSAO =
+    "Instância,Sementes,Orçamento,Alvo,Melhor FO,FO Média,Aval. Alvo,% Alvo";
+
+static bool lerBaseRegressao(const string &arquivo,
+                             vector<LinhaRegressao> &linhas) {
+  ifstream csv(arquivo);
+  if (!csv) {
+    cerr << "Erro: Nao foi possivel abrir " << arquivo << endl;
+    return false;
+  }
+  string linha;
+  getline(csv, linha);
+  while (getline(csv, linha)) {
+    if (aparar(linha).empty())
+      continue;
+    vector<string> campos;
+    stringstream ss(linha);
+    string campo;
+    while (getline(ss, campo, ','))
+      campos.push_back(aparar(campo));
+    if (campos.size() != 8) {
+      cerr << "Erro: linha invalida em " << arquivo << ": " << linha << endl;
+      return false;
+    }
+    LinhaRegressao l;
+    l.instancia = campos[0];
+    l.sementes = campos[1];
+    l.orcamento = atoll(campos[2].c_str());
+    l.alvo = atof(campos[3].c_str());
+    l.melhor = atof(campos[4].c_str());
+    l.media = atof(campos[5].c_str());
+    l.avalAlvo = atof(campos[6].c_str());
+    l.taxaAlvo = atof(campos[7].c_str());
+    linhas.push_back(l);
+  }
+  return !linhas.empty();
+}
+
+static bool gravarBaseRegressao(const string &arquivo,
+                                const vector<LinhaRegressao> &linhas) {
+  ofstream csv(arquivo);
+  if (!csv)
+    return false;
+  csv << CABECALHO_REGRESSAO << "\n";
+  for (const LinhaRegressao &l : linhas) {
+    csv << l.instancia << "," << l.sementes << "," << l.orcamento << ","
+        << numeroCSV(l.alvo, false) << "," << numeroCSV(l.melhor, false)
+        << "," << numeroCSV(l.media, false) << ","
+        << numeroCSV(l.avalAlvo, true) << "," << numeroCSV(l.taxaAlvo, true)
+        << "\n";
+  }
+  return static_cast<bool>(csv);
+}
+
+// Avaliacoes ate o custo chegar ao alvo; sem alcanca-lo, todas as gastas
+static long long avaliacoesAteAlvo(const ResultadoGRASP &r, double alvo) {
+  for (const MarcoConvergencia &marco : r.evolucao) {
+    if (marco.custo <= alvo + 0.0001)
+      return marco.avaliacoes;
+  }
+  return r.avaliacoes;
+}
+
+// Execucao longa, muito alem dos orcamentos da base (dezenas de segundos),
+// que limita a fracao de construcoes descartadas como repetidas: com o filtro
+// de duplicatas saturado, quase todas seriam descartadas
+static const char *INSTANCIA_LONGA = "E-n22-k4";
+static const long long ORCAMENTO_LONGO = 15000000;
+static const double MAX_REPETIDAS_LONGA = 5.0; // % das construcoes
+
+static bool verificarExecucaoLonga(const GRASPParams &base) {
+  auto contexto = carregarContexto(INSTANCIA_LONGA);
+  if (!contexto)
+    return false;
+  GRASPParams p = base;
+  p.verbose = false;
+  p.seed = 1;
+  p.max_iter = INT_MAX;
+  p.max_avaliacoes = ORCAMENTO_LONGO;
+  p.tempo_limite = -1;
+  p.estagnacao_tempo = -1;
+  p.run_number = -1;
+  p.inicio_mip.clear();
+  ResultadoGRASP r = contexto->executarGRASP(p);
+  long long construcoes = r.iteracoes + r.construcoesRepetidas;
+  double taxa = construcoes > 0 ? 100.0 * r.construcoesRepetidas / construcoes
+                                : 0.0;
+  bool ok = taxa <= MAX_REPETIDAS_LONGA;
+  printf("%s, %lld avaliacoes: %d de %lld construcoes repetidas (%.2f%%, "
+         "limite %.0f%%)  %s\n",
+         INSTANCIA_LONGA, r.avaliacoes, r.construcoesRepetidas, construcoes,
+         taxa, MAX_REPETIDAS_LONGA, ok ? "ok" : "FALHOU");
+  return ok;
+}
+
+// Construcoes por varredura em uma instancia X (folga de capacidade quase
+// nula): as completadas tem de caber na frota e ser validas, e a maioria
+// tem de se completar sem recorrer ao construtor guloso
+static const char *INSTANCIA_VARREDURA = "X-n214-k11";
+static const int CONSTRUCOES_VARREDURA = 50;
+static const double MIN_VARREDURAS_COMPLETAS = 80.0; // %
+
+static bool verificarVarredura(const GRASPParams &base) {
+  auto contexto = carregarContexto(INSTANCIA_VARREDURA);
+  if (!contexto)
+    return false;
+  const InstanciaEVRP &instancia = contexto->instancia;
+  const MatrizDistancia &dist = contexto->distancias();
+  OrdemAngular ordem = prepararOrdemAngular(instancia);
+  CacheReparo cache(base.cache_reparo);
+  Prazo prazo;
+  int completas = 0, invalidas = 0;
+  size_t maxRotas = 0;
+  for (int semente = 1; semente <= CONSTRUCOES_VARREDURA; semente++) {
+    mt19937 rng(semente);
+    Solucao sol;
+    if (!construirSolucaoVarredura(instancia, dist, ordem, rng, cache, prazo,
+                                   sol))
+      continue;
+    completas++;
+    maxRotas = max(maxRotas, sol.rotas.size());
+    if (!validarSolucao(instancia, sol.rotas, dist, false))
+      invalidas++;
+  }
+  double taxa = 100.0 * completas / CONSTRUCOES_VARREDURA;
+  bool ok = invalidas == 0 &&
+            static_cast<int>(maxRotas) <= instancia.veiculos &&
+            taxa >= MIN_VARREDURAS_COMPLETAS;
+  printf("%s, varredura: %d de %d completas (limite %.0f%%), %d invalidas, "
+         "ate %zu rotas (frota %d)  %s\n",
+         INSTANCIA_VARREDURA, completas, CONSTRUCOES_VARREDURA,
+         MIN_VARREDURAS_COMPLETAS, invalidas, maxRotas, instancia.veiculos,
+         ok ? "ok" : "FALHOU");
+  return ok;
+}
+
+int executarRegressao(const string &arquivoBase, bool gravarBase,
+                      const GRASPParams &base, double tolerancia,
+                      double toleranciaAlvo, int numThreads) {
+  vector<LinhaRegressao> linhasBase;
+  if (gravarBase) {
+    for (const CasoRegressao &c : CASOS_REGRESSAO) {
+      LinhaRegressao l;
+      l.instancia = c.instancia;
+      l.sementes = SEMENTES_REGRESSAO;
+      l.orcamento = c.orcamento;
+      linhasBase.push_back(l);
+    }
+  } else if (!lerBaseRegressao(arquivoBase, linhasBase)) {
+    return 1;
+  }
+
+  vector<shared_ptr<const ContextoSolver>> contextos;
+  struct Execucao {
+    int linha;
+    int semente;
+    ResultadoGRASP resultado;
+  };
+  vector<Execucao> execucoes;
+  for (size_t i = 0; i < linhasBase.size(); i++) {
+    vector<int> sementes;
+    if (!lerSementes(linhasBase[i].sementes, sementes)) {
+      cerr << "Erro: sementes invalidas: " << linhasBase[i].sementes << endl;
+      return 1;
+    }
+    auto contexto = carregarContexto(linhasBase[i].instancia);
+    if (!contexto)
+      return 1;
+    contextos.push_back(contexto);
+    for (int s : sementes)
+      execucoes.push_back({static_cast<int>(i), s, ResultadoGRASP()});
+  }
+
+  // So o orcamento de avaliacoes encerra as execucoes: nenhum criterio de
+  // tempo, para que o resultado seja o mesmo em qualquer maquina
+  executarParalelo(execucoes.size(), numThreads, [&](int k) {
+    Execucao &e = execucoes[k];
+    GRASPParams p = base;
+    p.verbose = false;
+    p.seed = e.semente;
+    p.max_iter = INT_MAX;
+    p.max_avaliacoes = linhasBase[e.linha].orcamento;
+    p.tempo_limite = -1;
+    p.estagnacao_tempo = -1;
+    p.run_number = -1;
+    p.inicio_mip.clear();
+    e.resultado = contextos[e.linha]->executarGRASP(p);
+  });
+
+  vector<LinhaRegressao> linhasAtuais = linhasBase;
+  for (size_t i = 0; i < linhasAtuais.size(); i++) {
+    LinhaRegressao &l = linhasAtuais[i];
+    double melhor = INFINITY, soma = 0;
+    int n = 0;
+    for (const Execucao &e : execucoes) {
+      if (e.linha != static_cast<int>(i))
+        continue;
+      melhor = min(melhor, e.resultado.custo);
+      soma += e.resultado.custo;
+      n++;
+    }
+    l.melhor = melhor;
+    l.media = soma / n;
+    // Base nova: o alvo e a propria FO media, com a precisao gravada no CSV
+    if (gravarBase)
+      l.alvo = atof(numeroCSV(l.media, false).c_str());
+    double somaAval = 0;
+    int alcancados = 0;
+    for (const Execucao &e : execucoes) {
+      if (e.linha != static_cast<int>(i))
+        continue;
+      somaAval += avaliacoesAteAlvo(e.resultado, l.alvo);
+      if (e.resultado.custo <= l.alvo + 0.0001)
+        alcancados++;
+    }
+    l.avalAlvo = round(somaAval / n);
+    l.taxaAlvo = round(100.0 * alcancados / n);
+  }
+
+  if (gravarBase) {
+    if (!gravarBaseRegressao(arquivoBase, linhasAtuais)) {
+      cerr << "Erro: Nao foi possivel gravar " << arquivoBase << endl;
+      return 1;
+    }
+    cout << "Base de regressao gravada em " << arquivoBase << endl;
+    return 0;
+  }
+
+  // Regressao: FO (melhor ou media) pior que a base alem de tolerancia %,
+  // ou mais avaliacoes ate o alvo alem de toleranciaAlvo %
+  int regressoes = 0;
+  printf("%-12s %15s %15s %15s %15s %12s %12s %5s  %s\n", "instancia",
+         "melhor base", "melhor atual", "media base", "media atual",
+         "aval. base", "aval. atual", "% alvo", "situacao");
+  for (size_t i = 0; i < linhasAtuais.size(); i++) {
+    const LinhaRegressao &b = linhasBase[i];
+    const LinhaRegressao &a = linhasAtuais[i];
+    bool piorMelhor = a.melhor > b.melhor * (1 + tolerancia / 100) + 1e-6;
+    bool piorMedia = a.media > b.media * (1 + tolerancia / 100) + 1e-6;
+    bool piorAlvo = a.avalAlvo > b.avalAlvo * (1 + toleranciaAlvo / 100);
+    string situacao = "ok";
+    if (piorMelhor || piorMedia || piorAlvo) {
+      regressoes++;
+      situacao = "REGRESSAO (";
+      situacao += piorMelhor ? "melhor " : "";
+      situacao += piorMedia ? "media " : "";
+      situacao += piorAlvo ? "alvo " : "";
+      situacao.back() = ')';
+    } else if (a.melhor < b.melhor - 1e-6 || a.media < b.media - 1e-6 ||
+               a.avalAlvo < b.avalAlvo) {
+      situacao = "melhorou";
+    }
+    printf("%-12s %15.6f %15.6f %15.6f %15.6f %12.0f %12.0f %5.0f  %s\n",
+           a.instancia.c_str(), b.melhor, a.melhor, b.media, a.media,
+           b.avalAlvo, a.avalAlvo, a.taxaAlvo, situacao.c_str());
+  }
+  bool longaOk = !base.filtro_duplicatas || verificarExecucaoLonga(base);
+  bool varreduraOk = verificarVarredura(base);
+  if (regressoes > 0) {
+    cout << "Regressao em " << regressoes << " de " << linhasAtuais.size()
+         << " instancias" << endl;
+    return 1;
+  }
+  if (!longaOk || !varreduraOk) {
+    cout << "Falha nas verificacoes adicionais" << endl;
+    return 1;
+  }
+  cout << "Sem regressoes (tolerancia " << tolerancia << "% na FO, "
+       << toleranciaAlvo << "% nas avaliacoes ate o alvo)" << endl;
+  return 0;
+}
+
+// "Melhor FO" de nome em um CSV no formato de resultados_grasp.csv
+static bool lerReferencia(const string &arquivo, const string &nome,
+                          double &valor) {
+  ifstream csv(arquivo);
+  string linha;
+  getline(csv, linha);
+  while (getline(csv, linha)) {
+    stringstream ss(linha);
+    string instancia, melhor;
+    if (getline(ss, instancia, ',') && getline(ss, melhor, ',') &&
+        aparar(instancia) == nome) {
+      valor = atof(melhor.c_str());
+      return valor > 0;
+    }
+  }
+  return false;
+}
+
+struct ExecucaoTTT {
+  int semente;
+  bool alcancou = false;
+  double tempo = 0;
+  int iteracoes = 0;
+  long long avaliacoes = 0;
+};
+
+int executarTTT(const string &nomeInstancia, const string &sementes,
+                const GRASPParams &base, double gap,
+                const string &arquivoReferencia, const string &arquivoSaida,
+                int numThreads) {
+  vector<int> valoresSementes;
+  if (!lerSementes(sementes, valoresSementes)) {
+    cerr << "Erro: sementes invalidas: " << sementes << endl;
+    return 1;
+  }
+  auto contexto = carregarContexto(nomeInstancia);
+  if (!contexto)
+    return 1;
+
+  double alvo = base.alvo;
+  double referencia = 0;
+  if (alvo <= 0) {
+    if (!lerReferencia(arquivoReferencia, contexto->nome, referencia)) {
+      cerr << "Erro: sem --target= e sem Melhor FO de " << contexto->nome
+           << " em " << arquivoReferencia << endl;
+      return 1;
+    }
+    alvo = referencia * (1 + gap / 100);
+  }
+
+  vector<ExecucaoTTT> execucoes(valoresSementes.size());
+  bool verbose = base.verbose;
+  mutex mutexSaida;
+  int concluidos = 0;
+  bool falhou = false;
+  executarParalelo(execucoes.size(), numThreads, [&](int k) {
+    ExecucaoTTT &e = execucoes[k];
+    e.semente = valoresSementes[k];
+    GRASPParams p = base;
+    p.verbose = false;
+    p.seed = e.semente;
+    p.alvo = alvo;
+    p.max_iter = INT_MAX;
+    if (p.tempo_limite <= 0)
+      p.tempo_limite = 300;
+    p.run_number = -1;
+    p.inicio_mip.clear();
+    ResultadoGRASP r = contexto->executarGRASP(p);
+    // Execucao que nao alcanca o alvo fica censurada no tempo total
+    e.alcancou = r.custo <= alvo + 0.0001;
+    e.tempo = e.alcancou ? r.tempoMelhor : r.tempo;
+    e.iteracoes = e.alcancou ? r.iterMelhor + 1 : r.iteracoes;
+    e.avaliacoes = e.alcancou ? r.avaliacoesMelhor : r.avaliacoes;
+    bool convergenciaGravada =
+        p.convergencia.empty() ||
+        gravarConvergencia(p.convergencia, contexto->nome, r);
+
+    lock_guard<mutex> trava(mutexSaida);
+    concluidos++;
+    if (!convergenciaGravada)
+      falhou = true;
+    if (verbose) {
+      cout << "[" << concluidos << "/" << execucoes.size() << "] seed "
+           << e.semente << ": " << fixed << setprecision(6) << r.custo
+           << (e.alcancou ? " alvo em " : " sem alvo em ") << e.tempo << " s"
+           << endl;
+    }
+  });
+
+  // Distribuicao empirica: execucao i (de n, em ordem de tempo) recebe
+  // probabilidade (i - 0.5) / n; as censuradas vao ao fim, sem probabilidade
+  stable_sort(execucoes.begin(), execucoes.end(),
+              [](const ExecucaoTTT &a, const ExecucaoTTT &b) {
+                if (a.alcancou != b.alcancou)
+                  return a.alcancou;
+                return a.tempo < b.tempo;
+              });
+  string arquivo =
+      arquivoSaida.empty() ? "ttt_" + contexto->nome + ".csv" : arquivoSaida;
+  ofstream csv(arquivo);
+  if (!csv) {
+    cerr << "Erro: Nao foi possivel gravar " << arquivo << endl;
+    return 1;
+  }
+  csv << "Semente,Tempo (seg.),Iterações,Avaliações,Alcançou,Probabilidade\n";
+  vector<double> tempos;
+  for (size_t i = 0; i < execucoes.size(); i++) {
+    const ExecucaoTTT &e = execucoes[i];
+    csv << e.semente << "," << numeroCSV(e.tempo, false) << "," << e.iteracoes
+        << "," << e.avaliacoes << "," << (e.alcancou ? 1 : 0) << ",";
+    if (e.alcancou) {
+      csv << numeroCSV((i + 0.5) / execucoes.size(), false);
+      tempos.push_back(e.tempo);
+    }
+    csv << "\n";
+  }
+  if (!csv) {
+    cerr << "Erro: Nao foi possivel gravar " << arquivo << endl;
+    return 1;
+  }
+
+  cout << fixed << setprecision(6) << "Alvo: " << alvo;
+  if (referencia > 0)
+    cout << " (" << defaultfloat << gap << "% acima de " << fixed
+         << referencia << ")";
+  cout << endl;
+  cout << "Alcancaram o alvo: " << tempos.size() << "/" << execucoes.size()
+       << endl;
+  if (!tempos.empty()) {
+    // tempos ja esta em ordem crescente
+    double soma = 0;
+    for (double t : tempos)
+      soma += t;
+    auto quantil = [&](double q) {
+      size_t k = static_cast<size_t>(ceil(q * tempos.size()));
+      return tempos[max<size_t>(k, 1) - 1];
+    };
+    cout << "Tempo ate o alvo (s): media " << soma / tempos.size()
+         << ", mediana " << quantil(0.5) << ", p90 " << quantil(0.9)
+         << ", max " << tempos.back() << endl;
+  }
+  cout << "Distribuicao gravada em " << arquivo << endl;
+  return falhou ? 1 : 0;
+}
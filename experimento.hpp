@@ -0,0 +1,48 @@
+#ifndef EXPERIMENTO_HPP
+#define EXPERIMENTO_HPP
+
+#include "grasp_solver.hpp"
+#include <string>
+
+using namespace std;
+
+// Bateria de experimentos do GRASP: todas as combinacoes (instancia,
+// semente) rodam em um pool de numThreads threads (<= 0: todos os
+// nucleos), com as instancias carregadas uma vez e compartilhadas. Os
+// trabalhos mais longos (estimados pelo tamanho da instancia) comecam
+// primeiro, para encurtar o tempo total. Cada execucao e gravada como em
+// --grasp (params.formato_solucao) e o resumo por instancia vai para
+// arquivoCSV no formato de resultados_grasp.csv.
+//
+// lista: arquivo com uma instancia por linha ou nomes separados por
+// virgula. sementes: "1-10", "1,5,7" ou combinacoes ("1-3,8").
+int executarExperimento(const string &lista, const string &sementes,
+                        const GRASPParams &base, const string &arquivoCSV,
+                        int numThreads = 0);
+
+// Regressao de qualidade: roda o GRASP nas instancias e sementes fixas de
+// arquivoBase (regressao_grasp.csv) com orcamento de avaliacoes de rota em
+// vez de tempo, o que torna o resultado deterministico entre maquinas, e
+// compara melhor FO, FO media e avaliacoes ate o alvo com a base. Retorna 1
+// se alguma instancia piorar alem das tolerancias (em %) ou se falhar uma
+// das verificacoes adicionais: a execucao longa nao pode descartar
+// construcoes repetidas demais e a varredura tem de respeitar a frota em
+// uma instancia X. Com gravarBase, roda o conjunto padrao e (re)grava
+// arquivoBase.
+int executarRegressao(const string &arquivoBase, bool gravarBase,
+                      const GRASPParams &base, double tolerancia = 0.1,
+                      double toleranciaAlvo = 10, int numThreads = 0);
+
+// Tempo ate o alvo (TTT): uma execucao por semente ate a melhor solucao
+// alcancar o alvo (--target= ou, sem ele, gap % acima da Melhor FO da
+// instancia em arquivoReferencia), limitada por base.tempo_limite (300 s se
+// nao definido). Grava em arquivoSaida (padrao ttt_<instancia>.csv) a
+// distribuicao empirica dos tempos, pronta para o grafico TTT, e imprime o
+// resumo. Com numThreads > 1 as execucoes disputam os nucleos: para tempos
+// comparaveis, use no maximo uma thread por nucleo livre.
+int executarTTT(const string &nomeInstancia, const string &sementes,
+                const GRASPParams &base, double gap,
+                const string &arquivoReferencia, const string &arquivoSaida,
+                int numThreads = 0);
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef GRASP_INTERNO_HPP
+#define GRASP_INTERNO_HPP
+
+#include "grasp_solver.hpp"
+#include "utils.hpp"
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Pecas internas do GRASP expostas para os micro-benchmarks (bench.cpp) e as
+// verificacoes da regressao (experimento.cpp).
+// Nao fazem parte da API: use executarGRASP/ContextoSolver.
+
+// Cache limitado de reparos de rota. A chave combina um hash rolante da
+// sequencia de clientes (sem estacoes) com a disponibilidade das estacoes;
+// cada slot guarda a chave completa para descartar colisoes. Mapeamento
+// direto: uma entrada nova substitui a que ocupava o slot.
+struct EntradaCacheReparo {
+  bool ocupada = false;
+  bool viavel = false;
+  uint64_t hash = 0;
+  vector<int> sequencia;
+  vector<uint64_t> disponibilidade;
+  vector<int> rotaReparada;
+  double custo = 0.0;
+};
+
+struct CacheReparo {
+  vector<EntradaCacheReparo> entradas;
+  long long acertos = 0;
+  long long falhas = 0;
+  long long avaliacoes = 0; // chamadas de repararRota, com ou sem cache
+
+  explicit CacheReparo(int tamanho) {
+    if (tamanho > 0) {
+      int potencia = 1;
+      while (potencia < tamanho)
+        potencia <<= 1;
+      entradas.resize(potencia);
+    }
+  }
+};
+
+// Prazo de execucao compartilhado por todas as fases. Nos lacos internos o
+// relogio so e lido a cada INTERVALO consultas, o que limita tanto o custo de
+// now() quanto o atraso apos o limite (no maximo INTERVALO avaliacoes).
+struct Prazo {
+  static const int INTERVALO = 64;
+  bool ativo = false;
+  bool expirado = false;
+  int consultas = 0;
+  chrono::high_resolution_clock::time_point limite;
+
+  bool expirou() {
+    if (!ativo || expirado)
+      return expirado;
+    if (++consultas < INTERVALO)
+      return false;
+    return verificarAgora();
+  }
+
+  bool verificarAgora() {
+    if (!ativo || expirado)
+      return expirado;
+    consultas = 0;
+    expirado = chrono::high_resolution_clock::now() >= limite;
+    return expirado;
+  }
+};
+
+struct Solucao {
+  vector<vector<int>> rotas;
+  double custo;
+};
+
+// Contadores da execucao em andamento nesta thread; executarGRASP os zera no
+// inicio e os copia para o resultado no fim
+extern thread_local EstatisticasGRASP estatisticasLocais;
+
+// Conta uma chamada e, ao sair do escopo, soma ao contador a duracao propria
+// dela: o tempo (estimado) dos reparos feitos no meio e descontado, pois ja
+// entra no contador do reparo
+struct CronometroOperador {
+  ContadorOperador &contador;
+  long long reparoInicio;
+  chrono::steady_clock::time_point inicio;
+
+  explicit CronometroOperador(ContadorOperador &c)
+      : contador(c), reparoInicio(estatisticasLocais.reparo.nanos),
+        inicio(chrono::steady_clock::now()) {}
+  ~CronometroOperador() {
+    contador.chamadas++;
+    contador.nanos += chrono::duration_cast<chrono::nanoseconds>(
+                          chrono::steady_clock::now() - inicio)
+                          .count() -
+                      (estatisticasLocais.reparo.nanos - reparoInicio);
+  }
+};
+
+int encontrarMelhorEstacao(const InstanciaEVRP &instancia,
+                           const MatrizDistancia &dist, int atual, int proximo,
+                           double energiaAtual,
+                           const vector<bool> &estacaoUsada);
+bool inserirEstacoesRota(const InstanciaEVRP &instancia,
+                         const MatrizDistancia &dist, vector<int> &rota,
+                         vector<bool> &estacaoUsada);
+double calcularCustoRota(const vector<int> &rota, const MatrizDistancia &dist);
+double calcularCustoTotal(const vector<vector<int>> &rotas,
+                          const MatrizDistancia &dist);
+vector<int> removerEstacoes(const InstanciaEVRP &instancia,
+                            const vector<int> &rota);
+Solucao construirSolucao(const InstanciaEVRP &instancia,
+                         const MatrizDistancia &dist, double alpha,
+                         mt19937 &rng, CacheReparo &cache, Prazo &prazo);
+
+// Clientes ordenados pelo angulo polar em torno do deposito, calculados uma
+// unica vez por execucao (O(n log n)) e reaproveitados por todas as
+// construcoes por varredura.
+struct OrdemAngular {
+  vector<double> angulos;
+  vector<int> clientes;
+  vector<double> demanda; // por indice de no
+  double amplitude = 0;   // arco (rad) que contem todos os clientes
+};
+
+OrdemAngular prepararOrdemAngular(const InstanciaEVRP &instancia);
+// Solucao completa, com rotas viaveis e no maximo instancia.veiculos delas;
+// false (sol fica incompleta) se a frota nao bastar, se um cliente nao for
+// atendido nem sozinho ou se o prazo esgotar no meio
+bool construirSolucaoVarredura(const InstanciaEVRP &instancia,
+                               const MatrizDistancia &dist,
+                               const OrdemAngular &ordem, mt19937 &rng,
+                               CacheReparo &cache, Prazo &prazo, Solucao &sol);
+
+// Cada operador aplica o primeiro movimento de melhora encontrado e retorna
+// true; false quando a solucao ja e otimo local para ele
+bool buscaLocalRelocate(const InstanciaEVRP &instancia,
+                        const MatrizDistancia &dist, Solucao &sol,
+                        CacheReparo &cache, Prazo &prazo);
+bool buscaLocal2Opt(const InstanciaEVRP &instancia, const MatrizDistancia &dist,
+                    Solucao &sol, CacheReparo &cache, Prazo &prazo);
+bool buscaLocalExchange(const InstanciaEVRP &instancia,
+                        const MatrizDistancia &dist, Solucao &sol,
+                        CacheReparo &cache, Prazo &prazo);
+
+#endif
@@ -1,58 +1,104 @@
 #include "grasp_solver.hpp"
+#include "grasp_interno.hpp"
+#include "modelo_mip.hpp"
+#include "progresso.hpp"
+#include "rastro.hpp"
+#include "solucao_io.hpp"
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <tuple>
 #include <vector>
 
 using namespace std;
 
-static void construirMatrizDistancia(const InstanciaEVRP &instancia,
-                                     vector<vector<double>> &dist) {
-  int n = instancia.dimensao;
-  int m = instancia.estacoesTotal;
-  int totalNos = n + m;
+thread_local EstatisticasGRASP estatisticasLocais;
 
-  dist.assign(totalNos, vector<double>(totalNos, 0.0));
+void ContadorOperador::somar(const ContadorOperador &outro) {
+  chamadas += outro.chamadas;
+  avaliados += outro.avaliados;
+  viaveis += outro.viaveis;
+  aceitos += outro.aceitos;
+  nanos += outro.nanos;
+  somaDelta += outro.somaDelta;
+}
 
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < n; j++) {
-      dist[i][j] = calcularDistancia(instancia.nos[i], instancia.nos[j]);
-    }
-  }
+void EstatisticasGRASP::somar(const EstatisticasGRASP &outras) {
+  construcao.somar(outras.construcao);
+  reparo.somar(outras.reparo);
+  doisOpt.somar(outras.doisOpt);
+  relocate.somar(outras.relocate);
+  exchange.somar(outras.exchange);
+  validacao.somar(outras.validacao);
+}
 
-  for (int i = 0; i < n; i++) {
-    for (int s = 0; s < m; s++) {
-      int idEstacaoFisica = s % instancia.estacoes;
-      int idEstacao = instancia.idEstacoes[idEstacaoFisica] - 1;
-      int indiceEstacao = n + s;
-      double d = calcularDistancia(instancia.nos[i], instancia.nos[idEstacao]);
-      dist[i][indiceEstacao] = d;
-      dist[indiceEstacao][i] = d;
-    }
+void escreverEstatisticas(EscritorJSON &j, const EstatisticasGRASP &e) {
+  const pair<const char *, const ContadorOperador *> operadores[] = {
+      {"construcao", &e.construcao}, {"reparo", &e.reparo},
+      {"2opt", &e.doisOpt},          {"relocate", &e.relocate},
+      {"exchange", &e.exchange},     {"validacao", &e.validacao},
+  };
+  j.abrirObjeto();
+  for (const auto &op : operadores) {
+    const ContadorOperador &c = *op.second;
+    j.chave(op.first);
+    j.abrirObjeto();
+    j.chave("chamadas");
+    j.valor(c.chamadas);
+    j.chave("avaliados");
+    j.valor(c.avaliados);
+    j.chave("viaveis");
+    j.valor(c.viaveis);
+    j.chave("aceitos");
+    j.valor(c.aceitos);
+    j.chave("tempo");
+    j.valor(c.nanos / 1e9);
+    j.chave("delta_medio");
+    j.valor(c.aceitos > 0 ? c.somaDelta / c.aceitos : 0.0);
+    j.fecharObjeto();
   }
+  j.fecharObjeto();
+}
 
-  for (int s1 = 0; s1 < m; s1++) {
-    for (int s2 = 0; s2 < m; s2++) {
-      int idEstacaoFisica1 = s1 % instancia.estacoes;
-      int idEstacaoFisica2 = s2 % instancia.estacoes;
-      int idEstacao1 = instancia.idEstacoes[idEstacaoFisica1] - 1;
-      int idEstacao2 = instancia.idEstacoes[idEstacaoFisica2] - 1;
-      int idx1 = n + s1;
-      int idx2 = n + s2;
-      dist[idx1][idx2] = calcularDistancia(instancia.nos[idEstacao1],
-                                           instancia.nos[idEstacao2]);
-    }
+bool emitirEstatisticas(const string &destino, const string &nomeBase,
+                        int semente, int execucoes, double tempo,
+                        const EstatisticasGRASP &e) {
+  EscritorJSON j;
+  j.abrirObjeto();
+  j.chave("instancia");
+  j.valor(nomeBase);
+  if (semente >= 0) {
+    j.chave("semente");
+    j.valor(semente);
   }
+  j.chave("execucoes");
+  j.valor(execucoes);
+  j.chave("tempo");
+  j.valor(tempo);
+  j.chave("operadores");
+  escreverEstatisticas(j, e);
+  j.fecharObjeto();
+
+  if (destino == "-") {
+    cout << j.saida << endl;
+    return true;
+  }
+  ofstream arquivo(destino, ios::app);
+  arquivo << j.saida << "\n";
+  return static_cast<bool>(arquivo);
 }
 
-static int encontrarMelhorEstacao(const InstanciaEVRP &instancia,
-                                  const vector<vector<double>> &dist, int atual,
-                                  int proximo, double energiaAtual,
-                                  const vector<bool> &estacaoUsada) {
+int encontrarMelhorEstacao(const InstanciaEVRP &instancia,
+                           const MatrizDistancia &dist, int atual,
+                           int proximo, double energiaAtual,
+                           const vector<bool> &estacaoUsada) {
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
   double h = instancia.consumoEnergia;
@@ -87,9 +133,9 @@ static int encontrarMelhorEstacao(const InstanciaEVRP &instancia,
   return melhor;
 }
 
-static bool inserirEstacoesRota(const InstanciaEVRP &instancia,
-                                const vector<vector<double>> &dist,
-                                vector<int> &rota, vector<bool> &estacaoUsada) {
+bool inserirEstacoesRota(const InstanciaEVRP &instancia,
+                         const MatrizDistancia &dist,
+                         vector<int> &rota, vector<bool> &estacaoUsada) {
   double h = instancia.consumoEnergia;
   double Q = instancia.capacidadeEnergia;
   int n = instancia.dimensao;
@@ -162,8 +208,8 @@ static bool inserirEstacoesRota(const InstanciaEVRP &instancia,
   return true;
 }
 
-static double calcularCustoRota(const vector<int> &rota,
-                                const vector<vector<double>> &dist) {
+double calcularCustoRota(const vector<int> &rota,
+                         const MatrizDistancia &dist) {
   double custo = 0.0;
   for (size_t i = 0; i < rota.size() - 1; i++) {
     custo += dist[rota[i]][rota[i + 1]];
@@ -171,8 +217,88 @@ static double calcularCustoRota(const vector<int> &rota,
   return custo;
 }
 
-static double calcularCustoTotal(const vector<vector<int>> &rotas,
-                                 const vector<vector<double>> &dist) {
+static bool calcularReparo(const InstanciaEVRP &instancia,
+                           const MatrizDistancia &dist, vector<int> &rota,
+                           vector<bool> &estacaoUsada, CacheReparo &cache,
+                           double &custo, ContadorOperador &est) {
+  if (cache.entradas.empty()) {
+    est.avaliados++;
+    bool viavel = inserirEstacoesRota(instancia, dist, rota, estacaoUsada);
+    custo = calcularCustoRota(rota, dist);
+    est.viaveis += viavel;
+    return viavel;
+  }
+
+  int n = instancia.dimensao;
+  vector<uint64_t> disponibilidade((estacaoUsada.size() + 63) / 64, 0);
+  for (size_t s = 0; s < estacaoUsada.size(); s++) {
+    if (estacaoUsada[s])
+      disponibilidade[s / 64] |= uint64_t(1) << (s % 64);
+  }
+
+  uint64_t h = 1469598103934665603ULL;
+  for (int no : rota) {
+    h = h * 1099511628211ULL + static_cast<uint64_t>(no + 1);
+  }
+  for (uint64_t palavra : disponibilidade) {
+    h ^= palavra + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  }
+
+  EntradaCacheReparo &e = cache.entradas[h & (cache.entradas.size() - 1)];
+  if (e.ocupada && e.hash == h && e.sequencia == rota &&
+      e.disponibilidade == disponibilidade) {
+    cache.acertos++;
+    rota = e.rotaReparada;
+    for (int no : rota) {
+      if (no >= n)
+        estacaoUsada[no - n] = true;
+    }
+    custo = e.custo;
+    est.viaveis += e.viavel;
+    return e.viavel;
+  }
+
+  est.avaliados++;
+  cache.falhas++;
+  e.ocupada = true;
+  e.hash = h;
+  e.sequencia = rota;
+  e.disponibilidade = disponibilidade;
+  e.viavel = inserirEstacoesRota(instancia, dist, rota, estacaoUsada);
+  e.rotaReparada = rota;
+  e.custo = calcularCustoRota(rota, dist);
+  custo = e.custo;
+  est.viaveis += e.viavel;
+  return e.viavel;
+}
+
+// Toda chamada e contada, mas so uma a cada AMOSTRA_TEMPO_REPARO e
+// cronometrada (e o tempo dela, multiplicado): sao dezenas de milhoes de
+// reparos, muitos resolvidos pelo cache, e duas leituras do relogio em cada
+// um pesariam mais que o proprio acerto.
+static const int AMOSTRA_TEMPO_REPARO = 64;
+
+static bool repararRota(const InstanciaEVRP &instancia,
+                        const MatrizDistancia &dist, vector<int> &rota,
+                        vector<bool> &estacaoUsada, CacheReparo &cache,
+                        double &custo) {
+  cache.avaliacoes++;
+  ContadorOperador &est = estatisticasLocais.reparo;
+  if (++est.chamadas % AMOSTRA_TEMPO_REPARO != 0)
+    return calcularReparo(instancia, dist, rota, estacaoUsada, cache, custo,
+                          est);
+  auto inicio = chrono::steady_clock::now();
+  bool viavel =
+      calcularReparo(instancia, dist, rota, estacaoUsada, cache, custo, est);
+  est.nanos += AMOSTRA_TEMPO_REPARO *
+               chrono::duration_cast<chrono::nanoseconds>(
+                   chrono::steady_clock::now() - inicio)
+                   .count();
+  return viavel;
+}
+
+double calcularCustoTotal(const vector<vector<int>> &rotas,
+                          const MatrizDistancia &dist) {
   double total = 0.0;
   for (const auto &rota : rotas) {
     total += calcularCustoRota(rota, dist);
@@ -180,8 +306,8 @@ static double calcularCustoTotal(const vector<vector<int>> &rotas,
   return total;
 }
 
-static vector<int> removerEstacoes(const InstanciaEVRP &instancia,
-                                   const vector<int> &rota) {
+vector<int> removerEstacoes(const InstanciaEVRP &instancia,
+                            const vector<int> &rota) {
   int n = instancia.dimensao;
   vector<int> limpa;
   for (int no : rota) {
@@ -192,29 +318,104 @@ static vector<int> removerEstacoes(const InstanciaEVRP &instancia,
   return limpa;
 }
 
-struct Solucao {
-  vector<vector<int>> rotas;
-  double custo;
+// Hash canonico: cada rota vira o hash da sua sequencia de clientes (sem
+// estacoes nem deposito) e o conjunto de rotas e ordenado antes de combinar,
+// de modo que a mesma particao em qualquer ordem de rotas tem o mesmo hash.
+static uint64_t hashSolucao(const InstanciaEVRP &instancia,
+                            const Solucao &sol) {
+  int n = instancia.dimensao;
+  vector<uint64_t> hashesRotas;
+  hashesRotas.reserve(sol.rotas.size());
+  for (const auto &rota : sol.rotas) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int no : rota) {
+      if (no >= 1 && no < n)
+        h = h * 1099511628211ULL + static_cast<uint64_t>(no);
+    }
+    hashesRotas.push_back(h);
+  }
+  sort(hashesRotas.begin(), hashesRotas.end());
+
+  uint64_t h = 0;
+  for (uint64_t hr : hashesRotas) {
+    h ^= hr + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+// Filtro de Bloom com as solucoes ja vistas (construcoes e estados das
+// descidas), em duas geracoes: quando a atual chega a FRACAO_MAXIMA dos bits
+// ligados, ela passa a ser a anterior e a mais antiga e descartada. Assim a
+// taxa de falsos positivos fica limitada (cerca de 1% com 4 hashes e 1/4 dos
+// bits ligados em cada geracao) por mais longa que seja a execucao, e a
+// memoria nao cresce com o numero de iteracoes. Um falso positivo apenas
+// descarta um recomeco.
+struct FiltroSolucoes {
+  static const int NUM_HASHES = 4;
+  static const int FRACAO_MAXIMA = 4; // gira com 1/4 dos bits ligados
+  vector<uint64_t> atual;
+  vector<uint64_t> anterior;
+  size_t ligados = 0; // bits ligados em atual
+
+  explicit FiltroSolucoes(int log2Bits)
+      : atual((size_t(1) << log2Bits) / 64, 0),
+        anterior((size_t(1) << log2Bits) / 64, 0) {}
+
+  // Retorna true se a solucao ja foi vista; caso contrario a registra.
+  bool verificarEInserir(uint64_t h) {
+    uint64_t mascara = atual.size() * 64 - 1;
+    uint64_t h1 = h;
+    uint64_t h2 = (h >> 32 | h << 32) * 0xff51afd7ed558ccdULL | 1;
+    bool vistaAtual = true, vistaAnterior = true;
+    for (int k = 0; k < NUM_HASHES; k++) {
+      uint64_t pos = (h1 + k * h2) & mascara;
+      uint64_t bit = uint64_t(1) << (pos % 64);
+      if (!(anterior[pos / 64] & bit))
+        vistaAnterior = false;
+      if (!(atual[pos / 64] & bit)) {
+        vistaAtual = false;
+        atual[pos / 64] |= bit;
+        ligados++;
+      }
+    }
+    if (ligados * FRACAO_MAXIMA >= atual.size() * 64) {
+      anterior.swap(atual);
+      fill(atual.begin(), atual.end(), 0);
+      ligados = 0;
+    }
+    return vistaAtual || vistaAnterior;
+  }
 };
 
-static Solucao construirSolucao(const InstanciaEVRP &instancia,
-                                const vector<vector<double>> &dist,
-                                double alpha, mt19937 &rng) {
+// Construcoes repetidas seguidas que encerram a execucao
+static const int MAX_REPETIDAS_SEGUIDAS = 1000;
+
+Solucao construirSolucao(const InstanciaEVRP &instancia,
+                         const MatrizDistancia &dist,
+                         double alpha, mt19937 &rng,
+                         CacheReparo &cache, Prazo &prazo) {
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
   int numClientes = n - 1;
   double C = instancia.capacidade;
+  ContadorOperador &est = estatisticasLocais.construcao;
+  CronometroOperador cronometro(est);
+  EscopoRastro rastro("construcao");
 
   vector<bool> visitado(numClientes + 1, false);
   vector<vector<int>> rotas;
   int clientesRestantes = numClientes;
 
-  while (clientesRestantes > 0) {
+  // Com o prazo esgotado a construcao fica incompleta e e descartada pela
+  // validacao no laco principal. O prazo e consultado a cada cliente
+  // inserido: uma construcao inteira pode ter menos rotas que o intervalo
+  // entre leituras do relogio.
+  while (clientesRestantes > 0 && !prazo.expirou()) {
     vector<int> rota = {0};
     double cargaAtual = 0;
     int atual = 0;
 
-    while (clientesRestantes > 0) {
+    while (clientesRestantes > 0 && !prazo.expirou()) {
       // Candidatos viáveis por capacidade
       vector<pair<double, int>> candidatos;
       for (int c = 1; c <= numClientes; c++) {
@@ -272,9 +473,13 @@ static Solucao construirSolucao(const InstanciaEVRP &instancia,
       }
     }
 
-    if (!inserirEstacoesRota(instancia, dist, rota, estacaoUsada)) {
+    double custoRota;
+    est.avaliados++;
+    if (!repararRota(instancia, dist, rota, estacaoUsada, cache, custoRota)) {
       // Fallback: rota não viável de energia, ainda assim a mantemos
       // A busca local pode corrigi-la
+    } else {
+      est.viaveis++;
     }
 
     rotas.push_back(rota);
@@ -286,20 +491,318 @@ static Solucao construirSolucao(const InstanciaEVRP &instancia,
   return sol;
 }
 
-static bool buscaLocalRelocate(
-    const InstanciaEVRP &instancia, const vector<vector<double>> &dist,
-    Solucao &sol,
-    chrono::high_resolution_clock::time_point deadline = {}) {
+OrdemAngular prepararOrdemAngular(const InstanciaEVRP &instancia) {
+  int n = instancia.dimensao;
+  const No &deposito = instancia.nos[0];
+
+  vector<pair<double, int>> porAngulo;
+  OrdemAngular ordem;
+  ordem.demanda.assign(n, 0.0);
+  for (int c = 1; c < n; c++) {
+    No noC = getNoByIndex(instancia, c);
+    ordem.demanda[c] = getDemandaByNodeId(instancia, noC.id);
+    porAngulo.push_back(
+        {atan2(noC.y - deposito.y, noC.x - deposito.x), c});
+  }
+  sort(porAngulo.begin(), porAngulo.end());
+
+  for (const auto &p : porAngulo) {
+    ordem.angulos.push_back(p.first);
+    ordem.clientes.push_back(p.second);
+  }
+  // Arco ocupado pelos clientes: a volta inteira menos o maior vazio entre
+  // angulos consecutivos (deposito no canto: bem menos que 2 pi)
+  double maiorVazio = 0;
+  for (size_t k = 0; k < ordem.angulos.size(); k++) {
+    double proximo = k + 1 < ordem.angulos.size()
+                         ? ordem.angulos[k + 1]
+                         : ordem.angulos[0] + 2 * M_PI;
+    maiorVazio = max(maiorVazio, proximo - ordem.angulos[k]);
+  }
+  ordem.amplitude = 2 * M_PI - maiorVazio;
+  return ordem;
+}
+
+// Estacoes usadas pelas rotas, exceto a de indice ignorada
+static vector<bool> estacoesUsadas(const InstanciaEVRP &instancia,
+                                   const vector<vector<int>> &rotas,
+                                   size_t ignorada) {
+  int n = instancia.dimensao;
+  vector<bool> usadas(instancia.estacoesTotal, false);
+  for (size_t r = 0; r < rotas.size(); r++) {
+    if (r == ignorada)
+      continue;
+    for (int no : rotas[r]) {
+      if (no >= n)
+        usadas[no - n] = true;
+    }
+  }
+  return usadas;
+}
+
+// Posicao mais barata (sem estacoes) para inserir cliente em limpa
+static size_t melhorPosicao(const MatrizDistancia &dist,
+                            const vector<int> &limpa, int cliente,
+                            double &delta) {
+  size_t posicao = 1;
+  delta = 1e18;
+  for (size_t j = 1; j < limpa.size(); j++) {
+    double d = dist[limpa[j - 1]][cliente] + dist[cliente][limpa[j]] -
+               dist[limpa[j - 1]][limpa[j]];
+    if (d < delta) {
+      delta = d;
+      posicao = j;
+    }
+  }
+  return posicao;
+}
+
+// Clientes que a varredura nao conseguiu atender com a frota, das maiores
+// demandas para as menores. Cada um vai para a rota com folga de capacidade
+// onde a insercao sai mais barata e que continua viavel apos reinserir as
+// estacoes. Se nenhuma tiver folga, ele toma o lugar de um cliente de
+// demanda menor, que volta para a fila: a demanda pendente sempre diminui,
+// entao o processo termina. Retorna false se algum cliente nao couber.
+static bool inserirSobras(const InstanciaEVRP &instancia,
+                          const MatrizDistancia &dist,
+                          const OrdemAngular &ordem, vector<int> sobras,
+                          vector<vector<int>> &rotas, CacheReparo &cache) {
+  int n = instancia.dimensao;
+  double C = instancia.capacidade;
+  ContadorOperador &est = estatisticasLocais.construcao;
+
+  vector<vector<int>> limpas;
+  vector<double> cargas;
+  for (const auto &rota : rotas) {
+    limpas.push_back(removerEstacoes(instancia, rota));
+    double carga = 0;
+    for (int no : limpas.back()) {
+      if (no >= 1 && no < n)
+        carga += ordem.demanda[no];
+    }
+    cargas.push_back(carga);
+  }
+
+  // Troca a rota r por limpa se ela for viavel com as estacoes
+  auto substituir = [&](size_t r, const vector<int> &limpa) {
+    vector<int> rota = limpa;
+    vector<bool> usadas = estacoesUsadas(instancia, rotas, r);
+    double custoRota;
+    est.avaliados++;
+    if (!repararRota(instancia, dist, rota, usadas, cache, custoRota))
+      return false;
+    est.viaveis++;
+    rotas[r] = rota;
+    limpas[r] = limpa;
+    return true;
+  };
+
+  while (!sobras.empty()) {
+    auto maior = max_element(sobras.begin(), sobras.end(), [&](int a, int b) {
+      return ordem.demanda[a] < ordem.demanda[b];
+    });
+    int cliente = *maior;
+    sobras.erase(maior);
+    double demanda = ordem.demanda[cliente];
+
+    // (custo da insercao, rota, posicao) para as rotas com folga
+    vector<tuple<double, size_t, size_t>> opcoes;
+    for (size_t r = 0; r < limpas.size(); r++) {
+      if (cargas[r] + demanda > C + 0.0001)
+        continue;
+      double delta;
+      size_t posicao = melhorPosicao(dist, limpas[r], cliente, delta);
+      opcoes.push_back({delta, r, posicao});
+    }
+    sort(opcoes.begin(), opcoes.end());
+    bool inserido = false;
+    for (const auto &opcao : opcoes) {
+      size_t r = get<1>(opcao);
+      vector<int> nova = limpas[r];
+      nova.insert(nova.begin() + get<2>(opcao), cliente);
+      if (substituir(r, nova)) {
+        cargas[r] += demanda;
+        inserido = true;
+        break;
+      }
+    }
+    if (inserido)
+      continue;
+
+    // Sem folga: troca por um cliente menor, o de menor demanda possivel
+    // para que ele tenha mais chance de caber em outra rota
+    vector<tuple<double, size_t, size_t>> trocas; // (demanda, rota, indice)
+    for (size_t r = 0; r < limpas.size(); r++) {
+      for (size_t i = 1; i + 1 < limpas[r].size(); i++) {
+        double d = ordem.demanda[limpas[r][i]];
+        if (d < demanda && cargas[r] - d + demanda <= C + 0.0001)
+          trocas.push_back({d, r, i});
+      }
+    }
+    sort(trocas.begin(), trocas.end());
+    for (const auto &troca : trocas) {
+      size_t r = get<1>(troca);
+      vector<int> nova = limpas[r];
+      int removido = nova[get<2>(troca)];
+      nova.erase(nova.begin() + get<2>(troca));
+      double delta;
+      size_t posicao = melhorPosicao(dist, nova, cliente, delta);
+      nova.insert(nova.begin() + posicao, cliente);
+      if (substituir(r, nova)) {
+        cargas[r] += demanda - get<0>(troca);
+        sobras.push_back(removido);
+        inserido = true;
+        break;
+      }
+    }
+    if (!inserido)
+      return false;
+  }
+  return true;
+}
+
+// Largura maxima do setor de uma rota, em setores medios (arco ocupado pelos
+// clientes dividido pela frota)
+static const double JANELA_SETOR = 1.5;
+
+// Reordena os clientes de rota (a partir do deposito em rota[0]) pelo vizinho
+// mais proximo: em ordem angular, uma rota de um setor longo e estreito
+// (deposito no canto) ziguezagueia entre perto e longe do deposito
+static void ordenarPorVizinhanca(const MatrizDistancia &dist,
+                                 vector<int> &rota) {
+  for (size_t i = 1; i < rota.size(); i++) {
+    size_t maisProximo = i;
+    for (size_t j = i + 1; j < rota.size(); j++) {
+      if (dist[rota[i - 1]][rota[j]] < dist[rota[i - 1]][rota[maisProximo]])
+        maisProximo = j;
+    }
+    swap(rota[i], rota[maisProximo]);
+  }
+}
+
+// Construcao por varredura: a partir de um angulo inicial sorteado, percorre
+// os clientes em ordem angular enchendo a rota do setor. Clientes que nao
+// cabem ficam para a rota seguinte e a varredura segue adiante, dentro de
+// uma janela angular a partir do primeiro cliente da rota, procurando
+// clientes menores que ainda caibam (first-fit em ordem angular), pois as
+// instancias X tem folga de capacidade quase nula. A rota visita os
+// clientes escolhidos pelo vizinho mais proximo. Se a insercao de
+// estacoes falhar, os ultimos clientes escolhidos sao devolvidos. A varredura
+// para ao esgotar a frota; os clientes que sobrarem sao inseridos nas rotas
+// com folga (ver inserirSobras). Retorna false se algum cliente ficar de
+// fora ou numa rota inviavel.
+bool construirSolucaoVarredura(const InstanciaEVRP &instancia,
+                               const MatrizDistancia &dist,
+                               const OrdemAngular &ordem, mt19937 &rng,
+                               CacheReparo &cache, Prazo &prazo, Solucao &sol) {
+  int m = instancia.estacoesTotal;
+  int numClientes = ordem.clientes.size();
+  double C = instancia.capacidade;
+  ContadorOperador &est = estatisticasLocais.construcao;
+  CronometroOperador cronometro(est);
+  EscopoRastro rastro("construcao");
+
+  uniform_real_distribution<double> sorteio(-M_PI, M_PI);
+  int inicio = lower_bound(ordem.angulos.begin(), ordem.angulos.end(),
+                           sorteio(rng)) -
+               ordem.angulos.begin();
+
+  vector<int> sequencia(numClientes);
+  for (int k = 0; k < numClientes; k++) {
+    sequencia[k] = ordem.clientes[(inicio + k) % numClientes];
+  }
+
+  vector<bool> atribuido(numClientes, false);
+  vector<vector<int>> rotas;
+  vector<bool> estacaoUsada(m, false);
+  int pos = 0;
+  double janela = JANELA_SETOR * ordem.amplitude / instancia.veiculos;
+
+  while (pos < numClientes && !prazo.expirou()) {
+    if (static_cast<int>(rotas.size()) == instancia.veiculos)
+      break;
+    vector<int> escolhidos;
+    double carga = 0;
+    double anguloInicial = ordem.angulos[(inicio + pos) % numClientes];
+    for (int k = pos; k < numClientes; k++) {
+      if (atribuido[k])
+        continue;
+      double giro = ordem.angulos[(inicio + k) % numClientes] - anguloInicial;
+      if (giro < 0)
+        giro += 2 * M_PI;
+      if (giro > janela)
+        break;
+      double demanda = ordem.demanda[sequencia[k]];
+      if (escolhidos.empty() || carga + demanda <= C + 0.0001) {
+        escolhidos.push_back(k);
+        carga += demanda;
+      }
+    }
+
+    vector<int> rota;
+    vector<bool> usadaRota;
+    bool viavel;
+    while (true) {
+      rota.assign(1, 0);
+      for (int k : escolhidos) {
+        rota.push_back(sequencia[k]);
+      }
+      ordenarPorVizinhanca(dist, rota);
+      rota.push_back(0);
+      usadaRota = estacaoUsada;
+
+      double custoRota;
+      est.avaliados++;
+      viavel = repararRota(instancia, dist, rota, usadaRota, cache, custoRota);
+      est.viaveis += viavel;
+      if (viavel || escolhidos.size() == 1)
+        break;
+      escolhidos.pop_back();
+    }
+    // Nem sozinho o cliente e atendido com as estacoes que restam
+    if (!viavel)
+      return false;
+
+    for (int k : escolhidos) {
+      atribuido[k] = true;
+    }
+    while (pos < numClientes && atribuido[pos]) {
+      pos++;
+    }
+    estacaoUsada = usadaRota;
+    rotas.push_back(rota);
+  }
+
+  vector<int> sobras;
+  for (int k = pos; k < numClientes; k++) {
+    if (!atribuido[k])
+      sobras.push_back(sequencia[k]);
+  }
+  // Prazo esgotado no meio da varredura tambem deixa clientes de fora
+  if (!sobras.empty() &&
+      (prazo.expirou() ||
+       !inserirSobras(instancia, dist, ordem, sobras, rotas, cache)))
+    return false;
+
+  sol.rotas = rotas;
+  sol.custo = calcularCustoTotal(rotas, dist);
+  return true;
+}
+
+bool buscaLocalRelocate(
+    const InstanciaEVRP &instancia, const MatrizDistancia &dist,
+    Solucao &sol, CacheReparo &cache,
+    Prazo &prazo) {
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
+  ContadorOperador &est = estatisticasLocais.relocate;
+  CronometroOperador cronometro(est);
+  EscopoRastro rastro("relocate");
   double C = instancia.capacidade;
 
   for (size_t r1 = 0; r1 < sol.rotas.size(); r1++) {
     vector<int> limpa1 = removerEstacoes(instancia, sol.rotas[r1]);
     for (size_t i = 1; i < limpa1.size() - 1; i++) {
-      if (deadline.time_since_epoch().count() > 0 &&
-          chrono::high_resolution_clock::now() >= deadline)
-        return false;
 
       int cliente = limpa1[i];
       No noCliente = getNoByIndex(instancia, cliente);
@@ -323,6 +826,9 @@ static bool buscaLocalRelocate(
           continue;
 
         for (size_t j = 1; j < limpa2.size(); j++) {
+          if (prazo.expirou())
+            return false;
+
           // Tentar inserir cliente na posição j da rota2
           vector<int> novaR1;
           for (int no : limpa1) {
@@ -336,6 +842,7 @@ static bool buscaLocalRelocate(
           novaR2.insert(novaR2.begin() + j, cliente);
 
           // Inserir estações
+          est.avaliados++;
           vector<bool> estacaoUsada(m, false);
           for (size_t rx = 0; rx < sol.rotas.size(); rx++) {
             if (rx == r1 || rx == r2)
@@ -347,19 +854,23 @@ static bool buscaLocalRelocate(
           }
 
           vector<bool> eu1 = estacaoUsada;
-          if (!inserirEstacoesRota(instancia, dist, novaR1, eu1))
+          double custoR1;
+          if (!repararRota(instancia, dist, novaR1, eu1, cache, custoR1))
             continue;
 
           vector<bool> eu2 = eu1;
-          if (!inserirEstacoesRota(instancia, dist, novaR2, eu2))
+          double custoR2;
+          if (!repararRota(instancia, dist, novaR2, eu2, cache, custoR2))
             continue;
 
+          est.viaveis++;
           double custoAntigo = calcularCustoRota(sol.rotas[r1], dist) +
                                calcularCustoRota(sol.rotas[r2], dist);
-          double custoNovo =
-              calcularCustoRota(novaR1, dist) + calcularCustoRota(novaR2, dist);
+          double custoNovo = custoR1 + custoR2;
 
           if (custoNovo < custoAntigo - 0.0001) {
+            est.aceitos++;
+            est.somaDelta += custoNovo - custoAntigo;
             sol.rotas[r1] = novaR1;
             sol.rotas[r2] = novaR2;
             sol.custo = calcularCustoTotal(sol.rotas, dist);
@@ -372,12 +883,15 @@ static bool buscaLocalRelocate(
   return false;
 }
 
-static bool buscaLocal2Opt(
-    const InstanciaEVRP &instancia, const vector<vector<double>> &dist,
-    Solucao &sol,
-    chrono::high_resolution_clock::time_point deadline = {}) {
+bool buscaLocal2Opt(
+    const InstanciaEVRP &instancia, const MatrizDistancia &dist,
+    Solucao &sol, CacheReparo &cache,
+    Prazo &prazo) {
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
+  ContadorOperador &est = estatisticasLocais.doisOpt;
+  CronometroOperador cronometro(est);
+  EscopoRastro rastro("2opt");
 
   for (size_t r = 0; r < sol.rotas.size(); r++) {
     vector<int> limpa = removerEstacoes(instancia, sol.rotas[r]);
@@ -385,13 +899,14 @@ static bool buscaLocal2Opt(
       continue;
 
     for (size_t i = 1; i < limpa.size() - 2; i++) {
-      if (deadline.time_since_epoch().count() > 0 &&
-          chrono::high_resolution_clock::now() >= deadline)
-        return false;
       for (size_t j = i + 1; j < limpa.size() - 1; j++) {
+        if (prazo.expirou())
+          return false;
+
         vector<int> nova = limpa;
         reverse(nova.begin() + i, nova.begin() + j + 1);
 
+        est.avaliados++;
         vector<bool> estacaoUsada(m, false);
         for (size_t rx = 0; rx < sol.rotas.size(); rx++) {
           if (rx == r)
@@ -402,13 +917,16 @@ static bool buscaLocal2Opt(
           }
         }
 
-        if (!inserirEstacoesRota(instancia, dist, nova, estacaoUsada))
+        double custoNovo;
+        if (!repararRota(instancia, dist, nova, estacaoUsada, cache, custoNovo))
           continue;
 
+        est.viaveis++;
         double custoAntigo = calcularCustoRota(sol.rotas[r], dist);
-        double custoNovo = calcularCustoRota(nova, dist);
 
         if (custoNovo < custoAntigo - 0.0001) {
+          est.aceitos++;
+          est.somaDelta += custoNovo - custoAntigo;
           sol.rotas[r] = nova;
           sol.custo = calcularCustoTotal(sol.rotas, dist);
           return true;
@@ -419,23 +937,26 @@ static bool buscaLocal2Opt(
   return false;
 }
 
-static bool buscaLocalExchange(
-    const InstanciaEVRP &instancia, const vector<vector<double>> &dist,
-    Solucao &sol,
-    chrono::high_resolution_clock::time_point deadline = {}) {
+bool buscaLocalExchange(
+    const InstanciaEVRP &instancia, const MatrizDistancia &dist,
+    Solucao &sol, CacheReparo &cache,
+    Prazo &prazo) {
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
+  ContadorOperador &est = estatisticasLocais.exchange;
+  CronometroOperador cronometro(est);
+  EscopoRastro rastro("exchange");
   double C = instancia.capacidade;
 
   for (size_t r1 = 0; r1 < sol.rotas.size(); r1++) {
     vector<int> limpa1 = removerEstacoes(instancia, sol.rotas[r1]);
     for (size_t i = 1; i < limpa1.size() - 1; i++) {
-      if (deadline.time_since_epoch().count() > 0 &&
-          chrono::high_resolution_clock::now() >= deadline)
-        return false;
       for (size_t r2 = r1 + 1; r2 < sol.rotas.size(); r2++) {
         vector<int> limpa2 = removerEstacoes(instancia, sol.rotas[r2]);
         for (size_t j = 1; j < limpa2.size() - 1; j++) {
+          if (prazo.expirou())
+            return false;
+
           int c1 = limpa1[i];
           int c2 = limpa2[j];
 
@@ -469,6 +990,7 @@ static bool buscaLocalExchange(
           novaR1[i] = c2;
           novaR2[j] = c1;
 
+          est.avaliados++;
           vector<bool> estacaoUsada(m, false);
           for (size_t rx = 0; rx < sol.rotas.size(); rx++) {
             if (rx == r1 || rx == r2)
@@ -480,19 +1002,23 @@ static bool buscaLocalExchange(
           }
 
           vector<bool> eu1 = estacaoUsada;
-          if (!inserirEstacoesRota(instancia, dist, novaR1, eu1))
+          double custoR1;
+          if (!repararRota(instancia, dist, novaR1, eu1, cache, custoR1))
             continue;
 
           vector<bool> eu2 = eu1;
-          if (!inserirEstacoesRota(instancia, dist, novaR2, eu2))
+          double custoR2;
+          if (!repararRota(instancia, dist, novaR2, eu2, cache, custoR2))
             continue;
 
+          est.viaveis++;
           double custoAntigo = calcularCustoRota(sol.rotas[r1], dist) +
                                calcularCustoRota(sol.rotas[r2], dist);
-          double custoNovo =
-              calcularCustoRota(novaR1, dist) + calcularCustoRota(novaR2, dist);
+          double custoNovo = custoR1 + custoR2;
 
           if (custoNovo < custoAntigo - 0.0001) {
+            est.aceitos++;
+            est.somaDelta += custoNovo - custoAntigo;
             sol.rotas[r1] = novaR1;
             sol.rotas[r2] = novaR2;
             sol.custo = calcularCustoTotal(sol.rotas, dist);
@@ -505,49 +1031,233 @@ static bool buscaLocalExchange(
   return false;
 }
 
+// Limite inferior barato para o custo, valido tambem com estacoes (pela
+// desigualdade triangular, retirar as estacoes de uma rota nao a encarece).
+// Usa o maior entre:
+//  - arvore geradora minima sobre deposito e clientes mais as kMin menores
+//    arestas do deposito (removendo uma aresta de deposito por rota resta
+//    uma arvore geradora);
+//  - relaxacao de grau: cada cliente paga metade das suas duas arestas mais
+//    curtas e o deposito metade das 2 * kMin menores arestas incidentes.
+// kMin = ceil(demanda total / capacidade) e o numero minimo de rotas.
+static double calcularLimiteInferior(const InstanciaEVRP &instancia,
+                                     const MatrizDistancia &dist) {
+  int n = instancia.dimensao;
+  if (n < 2)
+    return 0.0;
+
+  double demandaTotal = 0;
+  for (int c = 1; c < n; c++) {
+    No noC = getNoByIndex(instancia, c);
+    demandaTotal += getDemandaByNodeId(instancia, noC.id);
+  }
+  int kMin = max(1, (int)ceil(demandaTotal / instancia.capacidade - 1e-9));
+  kMin = min(kMin, n - 1);
+
+  vector<double> arestasDeposito;
+  for (int c = 1; c < n; c++) {
+    arestasDeposito.push_back(dist[0][c]);
+  }
+  sort(arestasDeposito.begin(), arestasDeposito.end());
+
+  // Prim O(n^2) sobre a matriz densa
+  vector<double> chave(n, 1e18);
+  vector<bool> naArvore(n, false);
+  chave[0] = 0.0;
+  double custoArvore = 0.0;
+  for (int k = 0; k < n; k++) {
+    int u = -1;
+    for (int v = 0; v < n; v++) {
+      if (!naArvore[v] && (u == -1 || chave[v] < chave[u]))
+        u = v;
+    }
+    naArvore[u] = true;
+    custoArvore += chave[u];
+    for (int v = 0; v < n; v++) {
+      if (!naArvore[v] && dist[u][v] < chave[v])
+        chave[v] = dist[u][v];
+    }
+  }
+  double limiteArvore = custoArvore;
+  for (int k = 0; k < kMin; k++) {
+    limiteArvore += arestasDeposito[k];
+  }
+
+  double limiteGrau = 0.0;
+  for (int c = 1; c < n; c++) {
+    // O deposito pode ser as duas pontas (rota 0 c 0)
+    double menor1 = dist[c][0], menor2 = dist[c][0];
+    for (int v = 1; v < n; v++) {
+      if (v == c)
+        continue;
+      if (dist[c][v] < menor1) {
+        menor2 = menor1;
+        menor1 = dist[c][v];
+      } else if (dist[c][v] < menor2) {
+        menor2 = dist[c][v];
+      }
+    }
+    limiteGrau += (menor1 + menor2) / 2.0;
+  }
+  // Cada cliente aparece no maximo duas vezes entre as pontas do deposito
+  double somaDeposito = 0.0;
+  for (int k = 0; k < 2 * kMin; k++) {
+    somaDeposito += arestasDeposito[k / 2];
+  }
+  limiteGrau += somaDeposito / 2.0;
+
+  return max(limiteArvore, limiteGrau);
+}
+
+// A busca local e deterministica: se a descida chega a um estado ja visto
+// (em 'vistas'), o restante dela repete uma descida anterior e e abandonado.
 static void buscaLocal(
-    const InstanciaEVRP &instancia, const vector<vector<double>> &dist,
-    Solucao &sol,
-    chrono::high_resolution_clock::time_point deadline = {}) {
+    const InstanciaEVRP &instancia, const MatrizDistancia &dist,
+    Solucao &sol, CacheReparo &cache, FiltroSolucoes *vistas,
+    Prazo &prazo) {
+  EscopoRastro rastro("busca local");
   bool melhorou = true;
   while (melhorou) {
-    if (deadline.time_since_epoch().count() > 0 &&
-        chrono::high_resolution_clock::now() >= deadline)
+    if (prazo.expirou())
       break;
     melhorou = false;
-    if (buscaLocal2Opt(instancia, dist, sol, deadline)) {
+    if (buscaLocal2Opt(instancia, dist, sol, cache, prazo) ||
+        buscaLocalRelocate(instancia, dist, sol, cache, prazo) ||
+        buscaLocalExchange(instancia, dist, sol, cache, prazo)) {
       melhorou = true;
-      continue;
+      if (vistas && vistas->verificarEInserir(hashSolucao(instancia, sol)))
+        break;
     }
-    if (buscaLocalRelocate(instancia, dist, sol, deadline)) {
-      melhorou = true;
-      continue;
+  }
+}
+
+// Validacao de uma candidata a melhor solucao (custo abaixo de melhorCusto):
+// se valida, ela e aceita e a melhora entra no delta da validacao
+static bool validarMelhora(const InstanciaEVRP &instancia,
+                           const MatrizDistancia &dist, const Solucao &sol,
+                           double melhorCusto) {
+  ContadorOperador &est = estatisticasLocais.validacao;
+  CronometroOperador cronometro(est);
+  est.avaliados++;
+  if (!validarSolucao(instancia, sol.rotas, dist, false))
+    return false;
+  est.viaveis++;
+  est.aceitos++;
+  if (melhorCusto < 1e18)
+    est.somaDelta += sol.custo - melhorCusto;
+  return true;
+}
+
+// Solucao em texto livre (formato lido por carregarSolucao e verify)
+static void gravarSolucaoTexto(const InstanciaEVRP &instancia,
+                               const MatrizDistancia &dist,
+                               const string &nomeBase,
+                               const string &solucaoArquivo,
+                               const Solucao &melhorSolucao, double tempoTotal,
+                               double tempoMelhor) {
+  ofstream solFile(solucaoArquivo);
+  solFile << "Instancia: " << nomeBase << endl;
+  solFile << fixed << setprecision(6);
+  solFile << "\nFO (Funcao Objetivo): " << melhorSolucao.custo << endl;
+  solFile << "TEMPO (seg): " << tempoTotal << endl;
+  solFile << "TEMPO_MELHOR (seg): " << tempoMelhor << endl;
+
+  solFile << "\nRotas:" << endl;
+  double distTotal = 0.0;
+  for (size_t r = 0; r < melhorSolucao.rotas.size(); r++) {
+    const auto &rota = melhorSolucao.rotas[r];
+    double distRota = calcularCustoRota(rota, dist);
+    distTotal += distRota;
+
+    double carga = 0;
+    int n = instancia.dimensao;
+    for (int no : rota) {
+      if (no >= 1 && no < n && !isEstacao(instancia, no)) {
+        No noN = getNoByIndex(instancia, no);
+        carga += getDemandaByNodeId(instancia, noN.id);
+      }
     }
-    if (buscaLocalExchange(instancia, dist, sol, deadline)) {
-      melhorou = true;
-      continue;
+
+    solFile << "Rota " << (r + 1) << ": ";
+    for (size_t i = 0; i < rota.size(); i++) {
+      solFile << rota[i];
+      if (i < rota.size() - 1)
+        solFile << " ";
     }
+    solFile << endl;
+    solFile << "  Distancia: " << distRota << endl;
+    solFile << "  Carga: " << carga << endl;
+    solFile << endl;
   }
+
+  solFile << "Numero de rotas: " << melhorSolucao.rotas.size() << endl;
+  solFile << "Distancia total: " << distTotal << endl;
+  solFile.close();
 }
 
-double resolverEVRPGRASP(const InstanciaEVRP &instancia,
-                         const string &nomeArquivo, const GRASPParams &params) {
-  if (params.verbose) {
-    imprimirInstanciaEVRP(instancia);
+bool aplicarOpcaoGRASP(const string &arg, GRASPParams &params, string &erro) {
+  erro.clear();
+  if (arg.rfind("--seed=", 0) == 0) {
+    params.seed = atoi(arg.substr(7).c_str());
+  } else if (arg.rfind("--alpha=", 0) == 0) {
+    params.alpha = atof(arg.substr(8).c_str());
+  } else if (arg.rfind("--max-iter=", 0) == 0) {
+    params.max_iter = atoi(arg.substr(11).c_str());
+  } else if (arg.rfind("--max-avaliacoes=", 0) == 0) {
+    params.max_avaliacoes = atoll(arg.substr(17).c_str());
+  } else if (arg.rfind("--tempo-limite=", 0) == 0) {
+    params.tempo_limite = atof(arg.substr(15).c_str());
+  } else if (arg.rfind("--cache-reparo=", 0) == 0) {
+    params.cache_reparo = atoi(arg.substr(15).c_str());
+  } else if (arg == "--sem-filtro-duplicatas") {
+    params.filtro_duplicatas = false;
+  } else if (arg.rfind("--target=", 0) == 0) {
+    params.alvo = atof(arg.substr(9).c_str());
+  } else if (arg.rfind("--gap=", 0) == 0) {
+    params.gap = atof(arg.substr(6).c_str());
+  } else if (arg.rfind("--estagnacao-iter=", 0) == 0) {
+    params.estagnacao_iter = atoi(arg.substr(18).c_str());
+  } else if (arg.rfind("--estagnacao-tempo=", 0) == 0) {
+    params.estagnacao_tempo = atof(arg.substr(19).c_str());
+  } else if (arg.rfind("--construtor=", 0) == 0) {
+    params.construtor = arg.substr(13);
+    if (params.construtor != "vizinho" && params.construtor != "varredura" &&
+        params.construtor != "misto") {
+      erro = "Invalid constructor: " + params.construtor;
+    }
+  } else if (arg.rfind("--convergencia=", 0) == 0) {
+    params.convergencia = arg.substr(15);
+  } else if (arg == "--stats") {
+    params.estatisticas = "-";
+  } else if (arg.rfind("--stats=", 0) == 0) {
+    params.estatisticas = arg.substr(8);
+  } else if (arg.rfind("--formato-solucao=", 0) == 0) {
+    params.formato_solucao = arg.substr(18);
+    if (params.formato_solucao != "txt" && params.formato_solucao != "jsonl" &&
+        params.formato_solucao != "bin") {
+      erro = "Invalid solution format: " + params.formato_solucao;
+    }
+  } else {
+    return false;
   }
+  return true;
+}
 
-  string nomeBase = nomeArquivo;
-  size_t posSlash = nomeBase.rfind('/');
-  if (posSlash != string::npos) {
-    nomeBase = nomeBase.substr(posSlash + 1);
-  }
-  size_t posExt = nomeBase.find(".evrp");
-  if (posExt != string::npos) {
-    nomeBase = nomeBase.substr(0, posExt);
+ResultadoGRASP executarGRASP(const InstanciaEVRP &instancia,
+                             const GRASPParams &params,
+                             const string &nomeBase) {
+  ResultadoGRASP resultado;
+  estatisticasLocais = EstatisticasGRASP();
+
+  // Usa a matriz do cache binario quando disponivel
+  shared_ptr<const MatrizDistancia> matriz = instancia.distancias;
+  if (!matriz) {
+    auto construida = make_shared<MatrizDistancia>();
+    construirMatrizDistancia(instancia, *construida);
+    matriz = construida;
   }
-
-  vector<vector<double>> dist;
-  construirMatrizDistancia(instancia, dist);
+  resultado.distancias = matriz;
+  const MatrizDistancia &dist = *matriz;
 
   unsigned int semente =
       (params.seed >= 0)
@@ -555,44 +1265,149 @@ double resolverEVRPGRASP(const InstanciaEVRP &instancia,
           : static_cast<unsigned int>(
                 chrono::system_clock::now().time_since_epoch().count());
   mt19937 rng(semente);
+  CacheReparo cache(params.cache_reparo);
+  FiltroSolucoes filtro(params.filtro_duplicatas ? 20 : 0);
+  FiltroSolucoes *vistas = params.filtro_duplicatas ? &filtro : nullptr;
+  int construcoesRepetidas = 0;
+  int repetidasSeguidas = 0;
+  long long construcoes = 0;
 
   auto inicio = chrono::high_resolution_clock::now();
-  auto deadline = chrono::high_resolution_clock::time_point{};
+  Prazo prazo;
   if (params.tempo_limite > 0) {
-    deadline = inicio + chrono::duration_cast<chrono::high_resolution_clock::duration>(
-                            chrono::duration<double>(params.tempo_limite));
+    prazo.ativo = true;
+    prazo.limite =
+        inicio + chrono::duration_cast<chrono::high_resolution_clock::duration>(
+                     chrono::duration<double>(params.tempo_limite));
+  }
+
+  RegistroProgresso progresso(nomeBase.empty() ? instancia.nome : nomeBase,
+                              "grasp", semente);
+
+  double limiteInferior = 0.0;
+  if (params.gap >= 0) {
+    limiteInferior = calcularLimiteInferior(instancia, dist);
+    progresso.limite(limiteInferior);
+    if (params.verbose) {
+      cout << "Limite inferior: " << fixed << setprecision(6)
+           << limiteInferior << endl;
+    }
+  }
+
+  OrdemAngular ordemAngular;
+  if (params.construtor != "vizinho") {
+    ordemAngular = prepararOrdemAngular(instancia);
   }
 
   Solucao melhorSolucao;
   melhorSolucao.custo = 1e18;
   double tempoMelhor = 0.0;
+  int iterMelhor = 0;
+  string motivoParada;
 
-  for (int iter = 0; iter < params.max_iter; iter++) {
-    if (deadline.time_since_epoch().count() > 0 &&
-        chrono::high_resolution_clock::now() >= deadline)
+  int iter = 0;
+  for (; iter < params.max_iter; iter++) {
+    progresso.iteracoes(iter);
+    if (prazo.verificarAgora())
       break;
+    // Orcamento conferido entre iteracoes: a ultima pode ultrapassa-lo, mas
+    // sempre do mesmo jeito para a mesma semente
+    if (params.max_avaliacoes >= 0 &&
+        cache.avaliacoes >= params.max_avaliacoes) {
+      motivoParada = "orcamento de avaliacoes";
+      break;
+    }
 
-    Solucao sol = construirSolucao(instancia, dist, params.alpha, rng);
+    // Paradas antecipadas: alvo, gap provado e estagnacao
+    if (params.alvo > 0 && melhorSolucao.custo <= params.alvo + 0.0001) {
+      motivoParada = "alvo atingido";
+      break;
+    }
+    if (params.gap >= 0 && melhorSolucao.custo < 1e18 &&
+        (melhorSolucao.custo - limiteInferior) / melhorSolucao.custo * 100.0 <=
+            params.gap) {
+      motivoParada = "gap atingido";
+      break;
+    }
+    if (params.estagnacao_iter > 0 &&
+        iter - iterMelhor >= params.estagnacao_iter) {
+      motivoParada = "estagnacao (iteracoes)";
+      break;
+    }
+    if (params.estagnacao_tempo > 0) {
+      double decorrido = chrono::duration<double>(
+                             chrono::high_resolution_clock::now() - inicio)
+                             .count();
+      if (decorrido - tempoMelhor >= params.estagnacao_tempo) {
+        motivoParada = "estagnacao (tempo)";
+        break;
+      }
+    }
+
+    EscopoRastro rastroIteracao("iteracao", "iter", iter + 1);
+
+    // "misto" alterna os dois construtores; a alternancia segue as
+    // construcoes, nao as iteracoes, para que uma repetida seja refeita com
+    // o outro construtor
+    bool varredura = params.construtor == "varredura" ||
+                     (params.construtor == "misto" && construcoes++ % 2 == 1);
+    // Varredura que nao coube na frota: a iteracao usa o construtor guloso
+    Solucao sol;
+    if (!varredura || !construirSolucaoVarredura(instancia, dist, ordemAngular,
+                                                 rng, cache, prazo, sol)) {
+      sol = construirSolucao(instancia, dist, params.alpha, rng, cache, prazo);
+    }
 
     // Aceitar solução construída antes da busca local se for válida
     if (sol.custo < melhorSolucao.custo &&
-        validarSolucao(instancia, sol.rotas, dist, false)) {
+        validarMelhora(instancia, dist, sol, melhorSolucao.custo)) {
       melhorSolucao = sol;
       auto agora = chrono::high_resolution_clock::now();
       tempoMelhor = chrono::duration<double>(agora - inicio).count();
+      iterMelhor = iter;
+      resultado.avaliacoesMelhor = cache.avaliacoes;
+      resultado.evolucao.push_back(
+          {tempoMelhor, iter + 1, cache.avaliacoes, melhorSolucao.custo});
+      eventoRastro("melhora", "custo", melhorSolucao.custo);
+      progresso.incumbente(melhorSolucao.custo);
       if (params.verbose) {
         cout << "Iteracao " << (iter + 1) << " (construcao): custo = " << fixed
              << setprecision(6) << melhorSolucao.custo << endl;
       }
     }
 
-    buscaLocal(instancia, dist, sol, deadline);
+    // Construcao identica a uma ja explorada: a busca local chegaria ao
+    // mesmo otimo local, entao ela e descartada e a iteracao, refeita com um
+    // novo recomeco. As primeiras max_iter repetidas nao contam para
+    // max_iter; as seguintes contam, para que ele ainda limite o trabalho
+    // (no maximo 2 * max_iter construcoes). Muitas repetidas seguidas
+    // indicam que o construtor ja nao produz nada novo.
+    if (vistas && vistas->verificarEInserir(hashSolucao(instancia, sol))) {
+      construcoesRepetidas++;
+      if (++repetidasSeguidas >= MAX_REPETIDAS_SEGUIDAS) {
+        motivoParada = "construcoes repetidas";
+        break;
+      }
+      if (construcoesRepetidas <= params.max_iter)
+        iter--;
+      continue;
+    }
+    repetidasSeguidas = 0;
+    estatisticasLocais.construcao.aceitos++;
+
+    buscaLocal(instancia, dist, sol, cache, vistas, prazo);
 
     if (sol.custo < melhorSolucao.custo &&
-        validarSolucao(instancia, sol.rotas, dist, false)) {
+        validarMelhora(instancia, dist, sol, melhorSolucao.custo)) {
       melhorSolucao = sol;
       auto agora = chrono::high_resolution_clock::now();
       tempoMelhor = chrono::duration<double>(agora - inicio).count();
+      iterMelhor = iter;
+      resultado.avaliacoesMelhor = cache.avaliacoes;
+      resultado.evolucao.push_back(
+          {tempoMelhor, iter + 1, cache.avaliacoes, melhorSolucao.custo});
+      eventoRastro("melhora", "custo", melhorSolucao.custo);
+      progresso.incumbente(melhorSolucao.custo);
       if (params.verbose) {
         cout << "Iteracao " << (iter + 1) << ": melhor custo = " << fixed
              << setprecision(6) << melhorSolucao.custo << endl;
@@ -600,70 +1415,169 @@ double resolverEVRPGRASP(const InstanciaEVRP &instancia,
     }
   }
 
+  progresso.iteracoes(iter);
   auto fim = chrono::high_resolution_clock::now();
-  double tempoTotal = chrono::duration<double>(fim - inicio).count();
+  resultado.custo = melhorSolucao.custo;
+  resultado.rotas = move(melhorSolucao.rotas);
+  resultado.tempo = chrono::duration<double>(fim - inicio).count();
+  resultado.tempoMelhor = tempoMelhor;
+  resultado.iteracoes = iter;
+  resultado.iterMelhor = iterMelhor;
+  resultado.semente = semente;
+  resultado.motivoParada = motivoParada;
+  resultado.cacheAcertos = cache.acertos;
+  resultado.cacheFalhas = cache.falhas;
+  resultado.construcoesRepetidas = construcoesRepetidas;
+  resultado.filtroAtivo = vistas != nullptr;
+  resultado.avaliacoes = cache.avaliacoes;
+  resultado.estatisticas = estatisticasLocais;
+  return resultado;
+}
 
-  // Salvar solução
-  string solucaoArquivo = "solucoes/" + nomeBase + "_GRASP";
-  if (params.seed >= 0) {
-    solucaoArquivo += "_seed" + to_string(params.seed);
+bool gravarConvergencia(const string &arquivo, const string &nomeBase,
+                        const ResultadoGRASP &resultado) {
+  static mutex trava;
+  lock_guard<mutex> guarda(trava);
+  bool novo = !ifstream(arquivo).good();
+  ofstream csv(arquivo, ios::app);
+  if (!csv)
+    return false;
+  if (novo) {
+    csv << "Instância,Semente,Tempo (seg.),Iteração,Avaliações,Custo\n";
   }
-  if (params.run_number >= 0) {
-    solucaoArquivo += "_run" + to_string(params.run_number + 1);
+  csv << fixed << setprecision(6);
+  for (const MarcoConvergencia &m : resultado.evolucao) {
+    csv << nomeBase << "," << resultado.semente << "," << m.tempo << ","
+        << m.iteracao << "," << m.avaliacoes << "," << m.custo << "\n";
   }
-  solucaoArquivo += ".txt";
+  return static_cast<bool>(csv);
+}
 
-  if (!params.verbose) {
-    cout << fixed << setprecision(6) << melhorSolucao.custo << " " << tempoMelhor
-         << endl;
+string gravarResultadoGRASP(const InstanciaEVRP &instancia,
+                            const string &nomeBase, const GRASPParams &params,
+                            const ResultadoGRASP &resultado) {
+  // Nos formatos estruturados seed e run ficam no registro e todas as
+  // execucoes da instancia sao anexadas ao mesmo arquivo
+  string solucaoArquivo = "solucoes/" + nomeBase + "_GRASP";
+  if (params.formato_solucao == "jsonl") {
+    solucaoArquivo += ".jsonl";
+  } else if (params.formato_solucao == "bin") {
+    solucaoArquivo += ".evrpsol";
+  } else {
+    if (params.seed >= 0) {
+      solucaoArquivo += "_seed" + to_string(params.seed);
+    }
+    if (params.run_number >= 0) {
+      solucaoArquivo += "_run" + to_string(params.run_number + 1);
+    }
+    solucaoArquivo += ".txt";
   }
-  ofstream solFile(solucaoArquivo);
-  solFile << "Instancia: " << nomeBase << endl;
-  solFile << fixed << setprecision(6);
-  solFile << "\nFO (Funcao Objetivo): " << melhorSolucao.custo << endl;
-  solFile << "TEMPO (seg): " << tempoTotal << endl;
-  solFile << "TEMPO_MELHOR (seg): " << tempoMelhor << endl;
 
-  solFile << "\nRotas:" << endl;
-  double distTotal = 0.0;
-  for (size_t r = 0; r < melhorSolucao.rotas.size(); r++) {
-    const auto &rota = melhorSolucao.rotas[r];
-    double distRota = calcularCustoRota(rota, dist);
-    distTotal += distRota;
-
-    double carga = 0;
-    int n = instancia.dimensao;
-    for (int no : rota) {
-      if (no >= 1 && no < n && !isEstacao(instancia, no)) {
-        No noN = getNoByIndex(instancia, no);
-        carga += getDemandaByNodeId(instancia, noN.id);
-      }
+  if (params.formato_solucao == "txt") {
+    Solucao melhorSolucao;
+    melhorSolucao.custo = resultado.custo;
+    melhorSolucao.rotas = resultado.rotas;
+    gravarSolucaoTexto(instancia, *resultado.distancias, nomeBase,
+                       solucaoArquivo, melhorSolucao, resultado.tempo,
+                       resultado.tempoMelhor);
+  } else {
+    RegistroSolucao registro;
+    registro.instancia = nomeBase;
+    registro.hashInstancia = hashInstancia(instancia);
+    registro.solver = "GRASP";
+    registro.custo = resultado.custo;
+    registro.tempo = resultado.tempo;
+    registro.tempoMelhor = resultado.tempoMelhor;
+    registro.seed = resultado.semente;
+    registro.run = params.run_number;
+    registro.rotas = resultado.rotas;
+    if (!anexarSolucao(solucaoArquivo, registro)) {
+      cerr << "Erro ao gravar solucao em " << solucaoArquivo << endl;
+      return "";
     }
+  }
 
-    solFile << "Rota " << (r + 1) << ": ";
-    for (size_t i = 0; i < rota.size(); i++) {
-      solFile << rota[i];
-      if (i < rota.size() - 1)
-        solFile << " ";
-    }
-    solFile << endl;
-    solFile << "  Distancia: " << distRota << endl;
-    solFile << "  Carga: " << carga << endl;
-    solFile << endl;
+  return solucaoArquivo;
+}
+
+double resolverEVRPGRASP(const InstanciaEVRP &instancia,
+                         const string &nomeArquivo, const GRASPParams &params) {
+  if (params.verbose) {
+    imprimirInstanciaEVRP(instancia);
   }
 
-  solFile << "Numero de rotas: " << melhorSolucao.rotas.size() << endl;
-  solFile << "Distancia total: " << distTotal << endl;
-  solFile.close();
+  string nomeBase = nomeBaseInstancia(nomeArquivo);
+
+  ResultadoGRASP resultado = executarGRASP(instancia, params, nomeBase);
+  const MatrizDistancia &dist = *resultado.distancias;
+  Solucao melhorSolucao;
+  melhorSolucao.custo = resultado.custo;
+  melhorSolucao.rotas = resultado.rotas;
+  double tempoTotal = resultado.tempo;
+  double tempoMelhor = resultado.tempoMelhor;
+
+  if (!params.verbose) {
+    cout << fixed << setprecision(6) << melhorSolucao.custo << " " << tempoMelhor
+         << endl;
+  }
+  string solucaoArquivo =
+      gravarResultadoGRASP(instancia, nomeBase, params, resultado);
 
   if (params.verbose) {
     cout << "\nSolucao salva em: " << solucaoArquivo << endl;
     cout << "Custo: " << melhorSolucao.custo << endl;
     cout << "Tempo: " << tempoTotal << " seg" << endl;
     cout << "Tempo melhor: " << tempoMelhor << " seg" << endl;
+    cout << "Avaliacoes: " << resultado.avaliacoes << " (melhor em "
+         << resultado.avaliacoesMelhor << ")" << endl;
+    if (!resultado.motivoParada.empty()) {
+      cout << "Parada antecipada: " << resultado.motivoParada << endl;
+    }
+    long long consultas = resultado.cacheAcertos + resultado.cacheFalhas;
+    cout << "Cache de reparo: " << resultado.cacheAcertos << " acertos, "
+         << resultado.cacheFalhas << " falhas";
+    if (consultas > 0) {
+      cout << " (" << setprecision(2)
+           << 100.0 * resultado.cacheAcertos / consultas << "%)"
+           << setprecision(6);
+    }
+    cout << endl;
+    if (resultado.filtroAtivo) {
+      cout << "Construcoes repetidas ignoradas: "
+           << resultado.construcoesRepetidas << endl;
+    }
 
     validarSolucao(instancia, melhorSolucao.rotas, dist, params.verbose);
   }
 
+  if (!params.convergencia.empty() &&
+      !gravarConvergencia(params.convergencia, nomeBase, resultado)) {
+    cerr << "Erro ao gravar convergencia: " << params.convergencia << endl;
+  }
+
+  if (!params.estatisticas.empty() &&
+      !emitirEstatisticas(params.estatisticas, nomeBase,
+                          static_cast<int>(resultado.semente), 1, tempoTotal,
+                          resultado.estatisticas)) {
+    cerr << "Erro ao gravar estatisticas: " << params.estatisticas << endl;
+  }
+
+  if (!params.inicio_mip.empty()) {
+    ModeloMIP modelo;
+    construirModeloEVRP(instancia, params.opcoes_lp, modelo);
+    modelo.nome = nomeBase;
+    vector<double> valores;
+    if (!valoresInicioMIP(modelo, instancia, melhorSolucao.rotas, valores)) {
+      cerr << "Erro: solucao usa arcos ausentes do modelo; inicio MIP nao "
+              "gerado"
+           << endl;
+    } else if (!gravarInicioMIP(modelo, valores, params.inicio_mip)) {
+      cerr << "Erro ao gravar inicio MIP: " << params.inicio_mip << endl;
+    } else if (params.verbose) {
+      cout << "Inicio MIP salvo em: " << params.inicio_mip << endl;
+      verificarInicioMIP(modelo, valores);
+    }
+  }
+
   return melhorSolucao.custo;
 }
@@ -1,20 +1,134 @@
 #ifndef GRASP_SOLVER_HPP
 #define GRASP_SOLVER_HPP
 
+#include "json.hpp"
 #include "utils.hpp"
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
 struct GRASPParams {
   double alpha = 0.3;
-  int max_iter = 100;
+  int max_iter = 100; // iterations; skipped duplicates count past max_iter
+  long long max_avaliacoes = -1; // stop once N route evaluations were spent
   int seed = -1;
   double tempo_limite = -1;
   bool verbose = true;
   int run_number = -1; // -1 = no suffix, >= 0 appends _runN to filename
+  int cache_reparo = 1 << 14; // slots in the route repair cache, 0 = disabled
+  bool filtro_duplicatas = true; // skip local search on already seen solutions
+  double alvo = -1;             // stop once the best cost reaches this value
+  double gap = -1;              // stop once (best - lower bound) / best <= gap %
+  int estagnacao_iter = -1;     // stop after K iterations without improvement
+  double estagnacao_tempo = -1; // stop after T seconds without improvement
+  string construtor = "vizinho"; // "vizinho" (RCL), "varredura" (sweep), "misto"
+  string formato_solucao = "txt"; // "txt", or "jsonl"/"bin" appended per run
+  string inicio_mip = "";  // write best solution as MIP start (.mst/.sol)
+  string estatisticas = ""; // per-operator counters as JSON: "-" stdout, or file
+  string convergencia = ""; // append (time, iteration, cost) per improvement (CSV)
+  OpcoesLP opcoes_lp;      // model options the MIP start must match
 };
 
+// Aplica uma opcao de linha de comando do GRASP ("--alpha=0.3",
+// "--max-iter=100", ...). Retorna false se arg nao e opcao do GRASP; valor
+// invalido deixa a mensagem em erro.
+bool aplicarOpcaoGRASP(const string &arg, GRASPParams &params, string &erro);
+
+// Contadores de uma fase ou operador. Movimentos "avaliados" sao os que
+// passam pelo filtro de capacidade e chegam ao reparo de energia; "viaveis",
+// os que o reparo aceita; "aceitos", os aplicados (somaDelta soma a variacao
+// de custo deles). No reparo, avaliados = reparos de fato calculados (fora
+// do cache). Os tempos sao proprios: o do reparo e descontado do operador
+// que o chama, entao as fases nao se sobrepoem e a soma delas aproxima o
+// tempo da execucao. O do reparo e estimado por amostragem (uma chamada
+// cronometrada a cada 64).
+struct ContadorOperador {
+  long long chamadas = 0;
+  long long avaliados = 0;
+  long long viaveis = 0;
+  long long aceitos = 0;
+  long long nanos = 0;
+  double somaDelta = 0;
+
+  void somar(const ContadorOperador &outro);
+};
+
+// Telemetria de uma execucao: acumulada por thread durante o GRASP (cada
+// execucao roda inteira em uma thread) e copiada para o resultado no fim;
+// somar junta execucoes diferentes
+struct EstatisticasGRASP {
+  ContadorOperador construcao; // avaliados/viaveis: rotas montadas
+  ContadorOperador reparo;
+  ContadorOperador doisOpt;
+  ContadorOperador relocate;
+  ContadorOperador exchange;
+  ContadorOperador validacao; // aceitos: novas melhores solucoes
+
+  void somar(const EstatisticasGRASP &outras);
+};
+
+// Escreve as estatisticas como objeto JSON, uma chave por operador
+void escreverEstatisticas(EscritorJSON &j, const EstatisticasGRASP &e);
+
+// Uma linha JSON com as estatisticas de uma ou mais execucoes (semente < 0:
+// omitida) em stdout (destino "-") ou acrescentada ao arquivo destino
+bool emitirEstatisticas(const string &destino, const string &nomeBase,
+                        int semente, int execucoes, double tempo,
+                        const EstatisticasGRASP &e);
+
+// Um ponto do perfil de convergencia: nova melhor solucao
+struct MarcoConvergencia {
+  double tempo;
+  int iteracao; // 1 = primeira iteracao
+  long long avaliacoes;
+  double custo;
+};
+
+// Resultado de uma execucao do GRASP, sem nenhuma saida em arquivo
+struct ResultadoGRASP {
+  double custo = 1e18;
+  vector<vector<int>> rotas;
+  double tempo = 0;
+  double tempoMelhor = 0;
+  int iteracoes = 0;
+  int iterMelhor = 0;
+  unsigned int semente = 0;
+  string motivoParada;
+  long long cacheAcertos = 0;
+  long long cacheFalhas = 0;
+  int construcoesRepetidas = 0;
+  bool filtroAtivo = false;
+  // Avaliacoes de rota (chamadas do reparo): medida de esforco que, ao
+  // contrario do tempo, nao depende da maquina
+  long long avaliacoes = 0;
+  long long avaliacoesMelhor = 0;
+  vector<MarcoConvergencia> evolucao; // uma entrada por melhora
+  EstatisticasGRASP estatisticas;
+  shared_ptr<const MatrizDistancia> distancias; // matriz usada na execucao
+};
+
+// Nucleo do GRASP: reutilizavel por modos que tratam a saida por conta
+// propria (servidor, experimentos). nomeBase identifica a execucao no
+// arquivo de status (vazio: instancia.nome).
+ResultadoGRASP executarGRASP(const InstanciaEVRP &instancia,
+                             const GRASPParams &params,
+                             const string &nomeBase = "");
+
+// Grava o resultado em solucoes/<nomeBase>_GRASP conforme
+// params.formato_solucao; retorna o arquivo ou vazio em caso de erro
+string gravarResultadoGRASP(const InstanciaEVRP &instancia,
+                            const string &nomeBase, const GRASPParams &params,
+                            const ResultadoGRASP &resultado);
+
+// Acrescenta o perfil de convergencia da execucao ao CSV arquivo (com
+// cabecalho se ele ainda nao existir); seguro para varias threads
+bool gravarConvergencia(const string &arquivo, const string &nomeBase,
+                        const ResultadoGRASP &resultado);
+
+// Executa o GRASP, grava a solucao em solucoes/ e imprime o resumo
 double resolverEVRPGRASP(const InstanciaEVRP &instancia,
                          const string &nomeArquivo,
                          const GRASPParams &params = GRASPParams());
@@ -1,5 +1,6 @@
 #include "gurobi_solver.hpp"
 #include "gurobi_c++.h"
+#include "progresso.hpp"
 #include <cstdio>
 #include <fstream>
 #include <iomanip>
@@ -9,22 +10,36 @@
 
 using namespace std;
 
-void resolverEVRPGurobi(const InstanciaEVRP &instancia,
-                        const string &nomeArquivo) {
+// Repassa incumbente, limite e nos explorados ao arquivo de status
+class CallbackProgresso : public GRBCallback {
+public:
+  explicit CallbackProgresso(RegistroProgresso &registro)
+      : registro(registro) {}
+
+protected:
+  void callback() override {
+    if (where != GRB_CB_MIP)
+      return;
+    registro.incumbente(getDoubleInfo(GRB_CB_MIP_OBJBST));
+    registro.limite(getDoubleInfo(GRB_CB_MIP_OBJBND));
+    registro.iteracoes(
+        static_cast<long long>(getDoubleInfo(GRB_CB_MIP_NODCNT)));
+  }
+
+private:
+  RegistroProgresso &registro;
+};
+
+void resolverEVRPGurobi(const ContextoSolver &contexto,
+                        const OpcoesLP &opcoes) {
+  const InstanciaEVRP &instancia = contexto.instancia;
+  const string &nomeBase = contexto.nome;
   imprimirInstanciaEVRP(instancia);
 
-  string nomeBase = nomeArquivo;
-  size_t posSlash = nomeBase.rfind('/');
-  if (posSlash != string::npos) {
-    nomeBase = nomeBase.substr(posSlash + 1);
+  string lpFilename = contexto.exportarModelo(opcoes);
+  if (lpFilename.empty()) {
+    return;
   }
-  size_t posExt = nomeBase.find(".evrp");
-  if (posExt != string::npos) {
-    nomeBase = nomeBase.substr(0, posExt);
-  }
-
-  string lpFilename = "lp/" + nomeBase + ".lp";
-  exportEVRPtoLP(instancia, "lp/" + nomeBase);
 
   int n = instancia.dimensao;
   int m = instancia.estacoesTotal;
@@ -70,8 +85,19 @@ void resolverEVRPGurobi(const InstanciaEVRP &instancia,
     model.set(GRB_DoubleParam_TimeLimit, 3600.0);
     model.set(GRB_DoubleParam_MIPGap, 0.0);
 
+    if (!opcoes.inicioMIP.empty()) {
+      cout << "Lendo inicio MIP: " << opcoes.inicioMIP << endl;
+      model.read(opcoes.inicioMIP);
+    }
+
     cout << "\nIniciando otimizacao com Gurobi..." << endl;
 
+    RegistroProgresso progresso(nomeBase, "gurobi");
+    CallbackProgresso callbackProgresso(progresso);
+    if (progresso.ativo()) {
+      model.setCallback(&callbackProgresso);
+    }
+
     model.optimize();
     double tempoTotal = model.get(GRB_DoubleAttr_Runtime);
 
@@ -1,8 +1,10 @@
 #ifndef GUROBI_SOLVER_HPP
 #define GUROBI_SOLVER_HPP
 
-#include "utils.hpp"
+#include "contexto_solver.hpp"
 
-void resolverEVRPGurobi(const InstanciaEVRP &instancia, const string &nomeArquivo);
+// Exporta o modelo pelo contexto (lp/<nome>.<formato>) e o resolve
+void resolverEVRPGurobi(const ContextoSolver &contexto,
+                        const OpcoesLP &opcoes = OpcoesLP());
 
 #endif
@@ -0,0 +1,269 @@
+#include "json.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+void EscritorJSON::separar() {
+  if (aposChave) {
+    aposChave = false;
+    return;
+  }
+  if (!vazio.empty()) {
+    if (!vazio.back())
+      saida += ',';
+    vazio.back() = 0;
+  }
+}
+
+void EscritorJSON::abrir(char c) {
+  separar();
+  saida += c;
+  vazio.push_back(1);
+}
+
+void EscritorJSON::fechar(char c) {
+  saida += c;
+  if (!vazio.empty())
+    vazio.pop_back();
+}
+
+void EscritorJSON::escreverString(string_view s) {
+  saida += '"';
+  for (char c : s) {
+    switch (c) {
+    case '"':
+      saida += "\\\"";
+      break;
+    case '\\':
+      saida += "\\\\";
+      break;
+    case '\n':
+      saida += "\\n";
+      break;
+    case '\t':
+      saida += "\\t";
+      break;
+    case '\r':
+      saida += "\\r";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char tmp[8];
+        snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+        saida += tmp;
+      } else {
+        saida += c;
+      }
+    }
+  }
+  saida += '"';
+}
+
+void EscritorJSON::chave(string_view nome) {
+  separar();
+  escreverString(nome);
+  saida += ':';
+  aposChave = true;
+}
+
+void EscritorJSON::valor(double v) {
+  if (!isfinite(v)) {
+    valorNulo();
+    return;
+  }
+  separar();
+  char tmp[32];
+  auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+  saida.append(tmp, r.ptr);
+}
+
+void EscritorJSON::valor(long long v) {
+  separar();
+  char tmp[24];
+  auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+  saida.append(tmp, r.ptr);
+}
+
+void EscritorJSON::valor(bool v) {
+  separar();
+  saida += v ? "true" : "false";
+}
+
+void EscritorJSON::valor(string_view v) {
+  separar();
+  escreverString(v);
+}
+
+void EscritorJSON::valorNulo() {
+  separar();
+  saida += "null";
+}
+
+static bool branco(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void LeitorJSON::pularBrancos() {
+  while (pos < texto.size() && branco(texto[pos]))
+    pos++;
+}
+
+bool LeitorJSON::consumir(char c) {
+  pularBrancos();
+  if (pos < texto.size() && texto[pos] == c) {
+    pos++;
+    return true;
+  }
+  return false;
+}
+
+bool LeitorJSON::esperar(char c) {
+  if (consumir(c))
+    return true;
+  erro = true;
+  return false;
+}
+
+bool LeitorJSON::lerString(string &destino) {
+  if (!esperar('"'))
+    return false;
+  destino.clear();
+  while (pos < texto.size()) {
+    char c = texto[pos++];
+    if (c == '"')
+      return true;
+    if (c != '\\') {
+      destino += c;
+      continue;
+    }
+    if (pos >= texto.size())
+      break;
+    char e = texto[pos++];
+    switch (e) {
+    case 'n':
+      destino += '\n';
+      break;
+    case 't':
+      destino += '\t';
+      break;
+    case 'r':
+      destino += '\r';
+      break;
+    case 'b':
+      destino += '\b';
+      break;
+    case 'f':
+      destino += '\f';
+      break;
+    case 'u': {
+      // Somente o intervalo ASCII e usado pelos arquivos do projeto
+      unsigned codigo = 0;
+      if (pos + 4 > texto.size())
+        break;
+      from_chars(texto.data() + pos, texto.data() + pos + 4, codigo, 16);
+      pos += 4;
+      destino += static_cast<char>(codigo < 0x80 ? codigo : '?');
+      break;
+    }
+    default:
+      destino += e;
+    }
+  }
+  erro = true;
+  return false;
+}
+
+bool LeitorJSON::lerNumero(double &destino) {
+  pularBrancos();
+  if (texto.compare(pos, 4, "null") == 0) {
+    pos += 4;
+    destino = NAN;
+    return true;
+  }
+  const char *inicio = texto.data() + pos;
+  auto r = from_chars(inicio, texto.data() + texto.size(), destino);
+  if (r.ec != errc()) {
+    erro = true;
+    return false;
+  }
+  pos += r.ptr - inicio;
+  return true;
+}
+
+bool LeitorJSON::lerInteiro(long long &destino) {
+  pularBrancos();
+  const char *inicio = texto.data() + pos;
+  const char *fimTexto = texto.data() + texto.size();
+  auto r = from_chars(inicio, fimTexto, destino);
+  if (r.ec == errc() &&
+      (r.ptr == fimTexto || (*r.ptr != '.' && *r.ptr != 'e' && *r.ptr != 'E'))) {
+    pos += r.ptr - inicio;
+    return true;
+  }
+  double v;
+  if (!lerNumero(v))
+    return false;
+  destino = static_cast<long long>(v);
+  return true;
+}
+
+bool LeitorJSON::lerBooleano(bool &destino) {
+  pularBrancos();
+  if (texto.compare(pos, 4, "true") == 0) {
+    pos += 4;
+    destino = true;
+    return true;
+  }
+  if (texto.compare(pos, 5, "false") == 0) {
+    pos += 5;
+    destino = false;
+    return true;
+  }
+  erro = true;
+  return false;
+}
+
+bool LeitorJSON::pularValor() {
+  pularBrancos();
+  if (pos >= texto.size()) {
+    erro = true;
+    return false;
+  }
+  char c = texto[pos];
+  if (c == '"') {
+    string descartada;
+    return lerString(descartada);
+  }
+  if (c == '{' || c == '[') {
+    char fechamento = c == '{' ? '}' : ']';
+    pos++;
+    if (consumir(fechamento))
+      return true;
+    do {
+      if (c == '{') {
+        string chave;
+        if (!lerString(chave) || !esperar(':'))
+          return false;
+      }
+      if (!pularValor())
+        return false;
+    } while (consumir(','));
+    return esperar(fechamento);
+  }
+  for (const char *literal : {"true", "false", "null"}) {
+    size_t tam = char_traits<char>::length(literal);
+    if (texto.compare(pos, tam, literal) == 0) {
+      pos += tam;
+      return true;
+    }
+  }
+  double descartado;
+  return lerNumero(descartado);
+}
+
+bool LeitorJSON::fim() {
+  pularBrancos();
+  return pos >= texto.size();
+}
@@ -0,0 +1,63 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Escrita incremental de JSON em uma string, com virgulas automaticas:
+//   EscritorJSON j; j.abrirObjeto(); j.chave("custo"); j.valor(1.5);
+//   j.fecharObjeto();  // j.saida == "{\"custo\":1.5}"
+struct EscritorJSON {
+  string saida;
+
+  void abrirObjeto() { abrir('{'); }
+  void fecharObjeto() { fechar('}'); }
+  void abrirLista() { abrir('['); }
+  void fecharLista() { fechar(']'); }
+  void chave(string_view nome);
+
+  void valor(double v);
+  void valor(long long v);
+  void valor(int v) { valor(static_cast<long long>(v)); }
+  void valor(bool v);
+  void valor(string_view v);
+  void valor(const char *v) { valor(string_view(v)); }
+  void valorNulo();
+
+private:
+  vector<char> vazio; // por nivel: nenhum elemento escrito ainda
+  bool aposChave = false;
+
+  void separar();
+  void abrir(char c);
+  void fechar(char c);
+  void escreverString(string_view s);
+};
+
+// Leitura sequencial de JSON sobre um texto ja em memoria. Cada metodo
+// pula espacos, consome o token esperado e retorna false (marcando erro)
+// se ele nao estiver la.
+struct LeitorJSON {
+  string_view texto;
+  size_t pos = 0;
+  bool erro = false;
+
+  explicit LeitorJSON(string_view t) : texto(t) {}
+
+  void pularBrancos();
+  // Consome c se for o proximo caractere nao branco
+  bool consumir(char c);
+  bool esperar(char c);
+  bool lerString(string &destino);
+  bool lerNumero(double &destino);
+  bool lerInteiro(long long &destino);
+  bool lerBooleano(bool &destino);
+  // Pula um valor qualquer (objeto, lista, string, numero, literal)
+  bool pularValor();
+  bool fim();
+};
+
+#endif
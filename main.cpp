@@ -1,6 +1,12 @@
+#include "afinador.hpp"
+#include "contexto_solver.hpp"
 #include "cplex_solver.hpp"
+#include "experimento.hpp"
 #include "grasp_solver.hpp"
 #include "gurobi_solver.hpp"
+#include "progresso.hpp"
+#include "rastro.hpp"
+#include "servidor.hpp"
 #include "utils.hpp"
 #include <cstdlib>
 #include <cstring>
@@ -9,12 +15,47 @@
 
 using namespace std;
 
+// Fim de qualquer modo: grava o status final (--status=) e o rastro pedido
+// com --trace=
+static int concluir(int codigo, const string &arquivoRastro) {
+  pararProgresso();
+  if (!arquivoRastro.empty() && !gravarRastro(arquivoRastro)) {
+    cerr << "Erro ao gravar rastro: " << arquivoRastro << endl;
+    return codigo != 0 ? codigo : 1;
+  }
+  return codigo;
+}
+
 int main(int argc, char *argv[]) {
   string nomeInstancia;
   string solver = "gurobi";
   GRASPParams graspParams;
   bool metaMode = false;
   int runs = 1;
+  bool usarCache = true;
+  OpcoesLP opcoesLP;
+  bool modoServidor = false;
+  string enderecoServidor;
+  double servidorOcioso = 0;
+  bool modoAfinacao = false;
+  string diretorioAfinacao = "tuning";
+  int numThreads = 0;
+  string listaExperimento;
+  string sementesExperimento;
+  string arquivoCSV = "resultados_grasp.csv";
+  bool modoRegressao = false;
+  string arquivoRegressao = "regressao_grasp.csv";
+  bool gravarBase = false;
+  double tolerancia = 0.1;
+  double toleranciaAlvo = 10;
+  string arquivoRastro;
+  string instanciaTTT;
+  double gapTTT = 1;
+  string referenciaTTT = "resultados_grasp.csv";
+  string saidaTTT;
+  string arquivoStatus;
+  double intervaloStatus = 1.0;
+  string erro;
 
   for (int i = 1; i < argc; i++) {
     string arg = argv[i];
@@ -26,14 +67,73 @@ int main(int argc, char *argv[]) {
       solver = "grasp";
     } else if (arg == "--meta") {
       metaMode = true;
-    } else if (arg.rfind("--seed=", 0) == 0) {
-      graspParams.seed = atoi(arg.substr(7).c_str());
-    } else if (arg.rfind("--alpha=", 0) == 0) {
-      graspParams.alpha = atof(arg.substr(8).c_str());
-    } else if (arg.rfind("--max-iter=", 0) == 0) {
-      graspParams.max_iter = atoi(arg.substr(11).c_str());
-    } else if (arg.rfind("--tempo-limite=", 0) == 0) {
-      graspParams.tempo_limite = atof(arg.substr(15).c_str());
+    } else if (aplicarOpcaoGRASP(arg, graspParams, erro)) {
+      if (!erro.empty()) {
+        cerr << erro << endl;
+        return 1;
+      }
+    } else if (arg == "--forcar-lp") {
+      opcoesLP.forcar = true;
+    } else if (arg == "--cortes") {
+      opcoesLP.cortes = true;
+    } else if (arg.rfind("--formato-lp=", 0) == 0) {
+      opcoesLP.formato = arg.substr(13);
+      if (!formatoModeloValido(opcoesLP.formato)) {
+        cerr << "Invalid model format: " << opcoesLP.formato << endl;
+        return 1;
+      }
+    } else if (arg.rfind("--inicio-mip=", 0) == 0) {
+      graspParams.inicio_mip = arg.substr(13);
+      opcoesLP.inicioMIP = arg.substr(13);
+    } else if (arg == "--sem-eliminacao-arcos") {
+      opcoesLP.eliminarArcos = false;
+    } else if (arg == "--sem-cache") {
+      usarCache = false;
+    } else if (arg == "--serve") {
+      modoServidor = true;
+    } else if (arg.rfind("--serve=", 0) == 0) {
+      modoServidor = true;
+      enderecoServidor = arg.substr(8);
+    } else if (arg.rfind("--serve-ocioso=", 0) == 0) {
+      servidorOcioso = atof(arg.substr(15).c_str());
+    } else if (arg == "--tune") {
+      modoAfinacao = true;
+    } else if (arg.rfind("--tune=", 0) == 0) {
+      modoAfinacao = true;
+      diretorioAfinacao = arg.substr(7);
+    } else if (arg.rfind("--experimento=", 0) == 0) {
+      listaExperimento = arg.substr(14);
+    } else if (arg.rfind("--seeds=", 0) == 0) {
+      sementesExperimento = arg.substr(8);
+    } else if (arg.rfind("--csv=", 0) == 0) {
+      arquivoCSV = arg.substr(6);
+    } else if (arg == "--regressao") {
+      modoRegressao = true;
+    } else if (arg.rfind("--regressao=", 0) == 0) {
+      modoRegressao = true;
+      arquivoRegressao = arg.substr(12);
+    } else if (arg == "--gravar-base") {
+      gravarBase = true;
+    } else if (arg.rfind("--tolerancia=", 0) == 0) {
+      tolerancia = atof(arg.substr(13).c_str());
+    } else if (arg.rfind("--tolerancia-alvo=", 0) == 0) {
+      toleranciaAlvo = atof(arg.substr(18).c_str());
+    } else if (arg.rfind("--ttt=", 0) == 0) {
+      instanciaTTT = arg.substr(6);
+    } else if (arg.rfind("--ttt-gap=", 0) == 0) {
+      gapTTT = atof(arg.substr(10).c_str());
+    } else if (arg.rfind("--ttt-referencia=", 0) == 0) {
+      referenciaTTT = arg.substr(17);
+    } else if (arg.rfind("--ttt-saida=", 0) == 0) {
+      saidaTTT = arg.substr(12);
+    } else if (arg.rfind("--status=", 0) == 0) {
+      arquivoStatus = arg.substr(9);
+    } else if (arg.rfind("--status-intervalo=", 0) == 0) {
+      intervaloStatus = atof(arg.substr(19).c_str());
+    } else if (arg.rfind("--trace=", 0) == 0) {
+      arquivoRastro = arg.substr(8);
+    } else if (arg.rfind("--threads=", 0) == 0) {
+      numThreads = atoi(arg.substr(10).c_str());
     } else if (arg.rfind("--runs=", 0) == 0) {
       runs = atoi(arg.substr(7).c_str());
     } else if (argv[i][0] != '-') {
@@ -44,6 +144,63 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (!arquivoRastro.empty()) {
+    iniciarRastro();
+  }
+  if (!arquivoStatus.empty() &&
+      !iniciarProgresso(arquivoStatus, intervaloStatus)) {
+    cerr << "Erro: Nao foi possivel gravar " << arquivoStatus << endl;
+    return 1;
+  }
+
+  if (modoServidor) {
+    graspParams.verbose = false;
+    return concluir(
+        executarServidor(enderecoServidor, graspParams, servidorOcioso),
+        arquivoRastro);
+  }
+
+  if (modoAfinacao) {
+    if (metaMode) {
+      graspParams.verbose = false;
+    }
+    return concluir(
+        executarAfinador(diretorioAfinacao, graspParams, numThreads),
+        arquivoRastro);
+  }
+
+  if (modoRegressao) {
+    return concluir(executarRegressao(arquivoRegressao, gravarBase,
+                                      graspParams, tolerancia, toleranciaAlvo,
+                                      numThreads),
+                    arquivoRastro);
+  }
+
+  if (!instanciaTTT.empty()) {
+    if (metaMode) {
+      graspParams.verbose = false;
+    }
+    return concluir(executarTTT(instanciaTTT,
+                                sementesExperimento.empty()
+                                    ? "1-100"
+                                    : sementesExperimento,
+                                graspParams, gapTTT, referenciaTTT, saidaTTT,
+                                numThreads),
+                    arquivoRastro);
+  }
+
+  if (!listaExperimento.empty()) {
+    if (metaMode) {
+      graspParams.verbose = false;
+    }
+    if (sementesExperimento.empty()) {
+      sementesExperimento = "1-10";
+    }
+    return concluir(executarExperimento(listaExperimento, sementesExperimento,
+                                        graspParams, arquivoCSV, numThreads),
+                    arquivoRastro);
+  }
+
   if (nomeInstancia.empty()) {
     cerr << "Error: instance name is required" << endl;
     return 1;
@@ -52,10 +209,14 @@ int main(int argc, char *argv[]) {
   if (metaMode) {
     graspParams.verbose = false;
   }
+  graspParams.opcoes_lp = opcoesLP;
 
-  InstanciaEVRP instancia;
+  // GRASP usa a matriz em todas as execucoes; os modelos MIP a constroem
+  // so se precisarem
+  shared_ptr<const ContextoSolver> contexto = carregarContexto(
+      nomeInstancia, usarCache, solver == "grasp", graspParams.verbose);
 
-  if (carregarInstancia(nomeInstancia, instancia)) {
+  if (contexto) {
     if (solver == "grasp") {
       if (graspParams.verbose) {
         cout << "Solver: GRASP" << endl;
@@ -68,16 +229,16 @@ int main(int argc, char *argv[]) {
             cout << "\n=== Run " << (r + 1) << "/" << runs << " ===" << endl;
           }
         }
-        resolverEVRPGRASP(instancia, nomeInstancia, p);
+        contexto->resolverGRASP(p);
       }
     } else if (solver == "gurobi") {
       cout << "Solver: GUROBI" << endl;
-      resolverEVRPGurobi(instancia, nomeInstancia);
+      resolverEVRPGurobi(*contexto, opcoesLP);
     } else {
       cout << "Solver: CPLEX" << endl;
-      resolverEVRP(instancia, nomeInstancia);
+      resolverEVRP(*contexto, opcoesLP);
     }
   }
 
-  return 0;
+  return concluir(0, arquivoRastro);
 }
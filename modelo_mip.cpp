@@ -0,0 +1,770 @@
+#include "modelo_mip.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <zlib.h>
+
+using namespace std;
+
+int ModeloMIP::adicionarColuna(string_view nomeCol, double custoCol,
+                               double inferior, double superior,
+                               bool binariaCol) {
+  custo.push_back(custoCol);
+  limiteInferior.push_back(inferior);
+  limiteSuperior.push_back(superior);
+  binaria.push_back(binariaCol ? 1 : 0);
+  nomesColunas.append(nomeCol.data(), nomeCol.size());
+  inicioNomeColuna.push_back(nomesColunas.size());
+  return numColunas() - 1;
+}
+
+bool ModeloMIP::fecharLinha(string_view nomeLin, char sentidoLin,
+                            double lado) {
+  size_t inicio = inicioLinha.back();
+  if (colunas.size() == inicio + 1) {
+    int c = colunas.back();
+    double a = coeficientes.back();
+    colunas.pop_back();
+    coeficientes.pop_back();
+    if (a != 0) {
+      double limite = lado / a;
+      if (a < 0 && sentidoLin != 'E')
+        sentidoLin = sentidoLin == 'L' ? 'G' : 'L';
+      if (binaria[c])
+        limite = sentidoLin == 'G' ? ceil(limite - 1e-9) : floor(limite + 1e-9);
+      if (sentidoLin != 'G')
+        limiteSuperior[c] = min(limiteSuperior[c], limite);
+      if (sentidoLin != 'L')
+        limiteInferior[c] = max(limiteInferior[c], limite);
+      linhasDobradas++;
+      return false;
+    }
+    // 0 x (sentido) lado: mantida como linha vazia para preservar uma
+    // eventual inviabilidade
+  }
+  inicioLinha.push_back(colunas.size());
+  sentido.push_back(sentidoLin);
+  ladoDireito.push_back(lado);
+  nomesLinhas.append(nomeLin.data(), nomeLin.size());
+  inicioNomeLinha.push_back(nomesLinhas.size());
+  return true;
+}
+
+// Monta "<prefixo><a>[_<b>]" em buf sem alocar
+static string_view nomeIndices(char (&buf)[64], const char *prefixo, int a,
+                               int b = -1) {
+  char *p = buf;
+  while (*prefixo)
+    *p++ = *prefixo++;
+  p = to_chars(p, buf + sizeof(buf), a).ptr;
+  if (b >= 0) {
+    *p++ = '_';
+    p = to_chars(p, buf + sizeof(buf), b).ptr;
+  }
+  return string_view(buf, p - buf);
+}
+
+void construirModeloEVRP(const InstanciaEVRP &instancia, const OpcoesLP &opcoes,
+                         ModeloMIP &modelo, EstatisticasModelo *estatisticas) {
+  int n = instancia.dimensao;
+  int m = instancia.estacoesTotal;
+  int numClientes = n - 1;
+  int totalNos = n + m;
+
+  double h = instancia.consumoEnergia;
+  double Q = instancia.capacidadeEnergia;
+  double C = instancia.capacidade;
+
+  // Distancias e demandas por indice calculadas uma vez (O(1) por consulta)
+  shared_ptr<const MatrizDistancia> matriz = instancia.distancias;
+  if (!matriz) {
+    auto construida = make_shared<MatrizDistancia>();
+    construirMatrizDistancia(instancia, *construida);
+    matriz = construida;
+  }
+  const MatrizDistancia &dist = *matriz;
+
+  vector<double> demanda(totalNos, 0.0);
+  for (int j = 0; j < totalNos; j++) {
+    No noJ = j < n ? instancia.nos[j] : getNoByIndex(instancia, j);
+    demanda[j] = getDemandaByNodeId(instancia, noJ.id);
+  }
+
+  vector<int> rechargingSources;
+  rechargingSources.push_back(0);
+  for (int k = totalNos - m; k < totalNos; k++) {
+    rechargingSources.push_back(k);
+  }
+
+  // Pre-processamento: arcos que nao aparecem em nenhuma solucao viavel
+  //  - copias da mesma estacao fisica (inclusive entre si);
+  //  - pares de clientes cuja demanda somada excede a capacidade;
+  //  - arcos i->j em que, saindo com a bateria cheia do ponto de recarga
+  //    mais proximo de i, nao sobra energia para chegar de j ao ponto de
+  //    recarga mais proximo de j: h * (dmin(i) + d(i,j) + dmin(j)) > Q.
+  vector<double> distRecarga(totalNos, 0.0);
+  for (int v = 1; v <= numClientes; v++) {
+    double menor = dist[v][0];
+    for (int s = 0; s < instancia.estacoes && s < m; s++) {
+      menor = min(menor, dist[v][n + s]);
+    }
+    distRecarga[v] = menor;
+  }
+
+  EstatisticasModelo stats;
+  modelo = ModeloMIP();
+  modelo.nome = instancia.nome;
+  modelo.totalNos = totalNos;
+  modelo.colunaArco.assign(static_cast<size_t>(totalNos) * totalNos, -1);
+
+  char nome[64];
+  for (int i = 0; i < totalNos; i++) {
+    for (int j = 0; j < totalNos; j++) {
+      if (i == j)
+        continue;
+      bool valido = true;
+      if (opcoes.eliminarArcos) {
+        if (i >= n && j >= n &&
+            (i - n) % instancia.estacoes == (j - n) % instancia.estacoes)
+          valido = false;
+        else if (i >= 1 && i <= numClientes && j >= 1 && j <= numClientes &&
+                 demanda[i] + demanda[j] > C + 0.0001)
+          valido = false;
+        else if (h * (distRecarga[i] + dist[i][j] + distRecarga[j]) >
+                 Q + 0.0001)
+          valido = false;
+      }
+
+      if (valido) {
+        modelo.colunaArco[static_cast<size_t>(i) * totalNos + j] =
+            modelo.adicionarColuna(nomeIndices(nome, "x_", i, j), dist[i][j],
+                                   0, 1, true);
+      } else {
+        stats.arcosRemovidos++;
+        // c5 quando i e cliente, c6 quando i recarrega, c7 sempre
+        if (i >= 1 && i <= numClientes)
+          stats.restricoesRemovidas += 1;
+        else if (j >= 1 && (i == 0 || i >= n))
+          stats.restricoesRemovidas += 1;
+        if (j >= 1)
+          stats.restricoesRemovidas += 1;
+      }
+    }
+  }
+  auto arco = [&](int i, int j) { return i != j && modelo.colunaX(i, j) >= 0; };
+
+  // Com cortes, limites apertados para clientes: a energia na chegada cobre
+  // ir ao ponto de recarga mais proximo (y_j >= h dmin(j)) e nao passa do
+  // que sobra vindo dele (y_j <= Q - h dmin(j)); a carga restante apos
+  // atender j e no maximo C - q_j.
+  modelo.inicioY = modelo.numColunas();
+  for (int i = 0; i < totalNos; i++) {
+    bool apertar = opcoes.cortes && i >= 1 && i <= numClientes;
+    double folga = apertar ? h * distRecarga[i] : 0.0;
+    modelo.adicionarColuna(nomeIndices(nome, "y_", i), 0, folga, Q - folga,
+                           false);
+  }
+  modelo.inicioU = modelo.numColunas();
+  for (int i = 0; i < totalNos; i++) {
+    bool apertar = opcoes.cortes && i >= 1 && i <= numClientes;
+    modelo.adicionarColuna(nomeIndices(nome, "u_", i), 0, 0,
+                           apertar ? C - demanda[i] : C, false);
+  }
+
+  // As antigas linhas c5a/c6a/c7a (y_j >= 0, u_j >= 0) e c8 (0 <= u_0 <= C)
+  // ja sao limites das colunas e nao entram no modelo.
+  for (int i = 1; i <= numClientes; i++) {
+    for (int j = 0; j < totalNos; j++) {
+      if (arco(i, j))
+        modelo.adicionarTermo(modelo.colunaX(i, j), 1);
+    }
+    modelo.fecharLinha(nomeIndices(nome, "c2_", i), 'E', 1);
+  }
+
+  for (int s = 0; s < m; s++) {
+    int idx = n + s;
+    for (int j = 0; j < totalNos; j++) {
+      if (arco(idx, j))
+        modelo.adicionarTermo(modelo.colunaX(idx, j), 1);
+    }
+    modelo.fecharLinha(nomeIndices(nome, "c3_", s + 1), 'L', 1);
+  }
+
+  for (int j = 1; j < totalNos; j++) {
+    for (int i = 0; i < totalNos; i++) {
+      if (arco(j, i))
+        modelo.adicionarTermo(modelo.colunaX(j, i), 1);
+    }
+    for (int i = 0; i < totalNos; i++) {
+      if (arco(i, j))
+        modelo.adicionarTermo(modelo.colunaX(i, j), -1);
+    }
+    modelo.fecharLinha(nomeIndices(nome, "c4_", j), 'E', 0);
+  }
+
+  for (int i = 1; i <= numClientes; i++) {
+    for (int j = 0; j < totalNos; j++) {
+      if (arco(i, j)) {
+        modelo.adicionarTermo(modelo.colunaY(j), 1);
+        modelo.adicionarTermo(modelo.colunaY(i), -1);
+        modelo.adicionarTermo(modelo.colunaX(i, j), h * dist[i][j] + Q);
+        modelo.fecharLinha(nomeIndices(nome, "c5_", i, j), 'L', Q);
+      }
+    }
+  }
+
+  for (int j = 1; j < totalNos; j++) {
+    for (int i : rechargingSources) {
+      if (arco(i, j)) {
+        modelo.adicionarTermo(modelo.colunaY(j), 1);
+        modelo.adicionarTermo(modelo.colunaX(i, j), h * dist[i][j]);
+        modelo.fecharLinha(nomeIndices(nome, "c6_", j, i), 'L', Q);
+      }
+    }
+  }
+
+  for (int j = 1; j < totalNos; j++) {
+    for (int i = 0; i < totalNos; i++) {
+      if (arco(i, j)) {
+        modelo.adicionarTermo(modelo.colunaU(j), 1);
+        modelo.adicionarTermo(modelo.colunaU(i), -1);
+        modelo.adicionarTermo(modelo.colunaX(i, j), C + demanda[j]);
+        modelo.fecharLinha(nomeIndices(nome, "c7_", j, i), 'L', C);
+      }
+    }
+  }
+
+  // Cortes estaticos (opcionais), todos validos para qualquer solucao:
+  //  c9/c10: kMin <= rotas saindo do deposito <= veiculos, com
+  //          kMin = ceil(demanda total / capacidade);
+  //  c11:    as copias de uma mesma estacao fisica sao usadas em ordem
+  //          (copia t+1 so sai se a copia t sair), quebrando a simetria.
+  if (opcoes.cortes) {
+    double demandaTotal = 0;
+    for (int i = 1; i <= numClientes; i++) {
+      demandaTotal += demanda[i];
+    }
+    int kMin = max(1, (int)ceil(demandaTotal / C - 1e-9));
+
+    for (int j = 1; j < totalNos; j++) {
+      if (arco(0, j))
+        modelo.adicionarTermo(modelo.colunaX(0, j), 1);
+    }
+    modelo.fecharLinha("c9", 'L', instancia.veiculos);
+    for (int j = 1; j < totalNos; j++) {
+      if (arco(0, j))
+        modelo.adicionarTermo(modelo.colunaX(0, j), 1);
+    }
+    modelo.fecharLinha("c10", 'G', kMin);
+    stats.cortesAdicionados += 2;
+
+    for (int e = 0; e < instancia.estacoes; e++) {
+      for (int t = 0; n + e + (t + 1) * instancia.estacoes < totalNos; t++) {
+        int atual = n + e + t * instancia.estacoes;
+        int proxima = atual + instancia.estacoes;
+        for (int j = 0; j < totalNos; j++) {
+          if (arco(proxima, j))
+            modelo.adicionarTermo(modelo.colunaX(proxima, j), 1);
+        }
+        for (int j = 0; j < totalNos; j++) {
+          if (arco(atual, j))
+            modelo.adicionarTermo(modelo.colunaX(atual, j), -1);
+        }
+        modelo.fecharLinha(nomeIndices(nome, "c11_", e, t), 'L', 0);
+        stats.cortesAdicionados++;
+      }
+    }
+  }
+
+  if (estatisticas)
+    *estatisticas = stats;
+}
+
+// Destino do arquivo de modelo: texto simples ou gzip
+struct SaidaModelo {
+  FILE *arquivo = nullptr;
+  gzFile comprimido = nullptr;
+  bool erro = false;
+
+  void escrever(const char *dados, size_t bytes) {
+    if (bytes == 0)
+      return;
+    if (comprimido) {
+      if (gzwrite(comprimido, dados, static_cast<unsigned>(bytes)) == 0)
+        erro = true;
+    } else if (fwrite(dados, 1, bytes, arquivo) != bytes) {
+      erro = true;
+    }
+  }
+  void escrever(const string &s) { escrever(s.data(), s.size()); }
+};
+
+// Buffer de texto dos formatos de modelo: numeros com to_chars; valores
+// inteiros saem sem casas decimais, os demais com 6 (como
+// 'fixed << setprecision(6)').
+struct BufferModelo {
+  string dados;
+
+  BufferModelo &operator<<(const char *s) {
+    dados += s;
+    return *this;
+  }
+  BufferModelo &operator<<(string_view s) {
+    dados.append(s.data(), s.size());
+    return *this;
+  }
+  BufferModelo &operator<<(int v) {
+    char tmp[16];
+    auto r = to_chars(tmp, tmp + sizeof(tmp), v);
+    dados.append(tmp, r.ptr);
+    return *this;
+  }
+  BufferModelo &operator<<(double v) {
+    char tmp[64];
+    to_chars_result r;
+    if (v == floor(v) && fabs(v) < 1e15)
+      r = to_chars(tmp, tmp + sizeof(tmp), static_cast<long long>(v));
+    else
+      r = to_chars(tmp, tmp + sizeof(tmp), v, chars_format::fixed, 6);
+    dados.append(tmp, r.ptr);
+    return *this;
+  }
+};
+
+// Gera os itens 0..total-1 de uma secao em paralelo, em blocos de itens
+// consecutivos com um buffer por bloco, e grava os blocos na ordem original
+// assim que cada lote fica pronto.
+static void emitirSecao(SaidaModelo &saida, int total,
+                        const function<void(int, BufferModelo &)> &gerar) {
+  const int itensPorBloco = 1024;
+  int numThreads = max(1u, thread::hardware_concurrency());
+  int totalBlocos = (total + itensPorBloco - 1) / itensPorBloco;
+  int tamanhoLote = numThreads * 4;
+  vector<BufferModelo> buffers(tamanhoLote);
+
+  for (int inicio = 0; inicio < totalBlocos; inicio += tamanhoLote) {
+    int fim = min(totalBlocos, inicio + tamanhoLote);
+    executarParalelo(fim - inicio, numThreads, [&](int k) {
+      buffers[k].dados.clear();
+      int primeiro = (inicio + k) * itensPorBloco;
+      int ultimo = min(total, primeiro + itensPorBloco);
+      for (int item = primeiro; item < ultimo; item++)
+        gerar(item, buffers[k]);
+    });
+    for (int k = 0; k < fim - inicio; k++) {
+      saida.escrever(buffers[k].dados);
+    }
+  }
+}
+
+static void escreverTermoLP(BufferModelo &b, double coef, string_view nome,
+                            bool primeiro) {
+  if (coef < 0) {
+    b << (primeiro ? "- " : " - ");
+    coef = -coef;
+  } else if (!primeiro) {
+    b << " + ";
+  }
+  if (coef != 1.0)
+    b << coef << " ";
+  b << nome;
+}
+
+static void gravarLP(const ModeloMIP &modelo, SaidaModelo &saida) {
+  saida.escrever(string("Minimize\n obj: "));
+
+  int primeiraComCusto = 0;
+  while (primeiraComCusto < modelo.numColunas() &&
+         modelo.custo[primeiraComCusto] == 0)
+    primeiraComCusto++;
+  emitirSecao(saida, modelo.numColunas(), [&](int c, BufferModelo &b) {
+    if (modelo.custo[c] != 0)
+      escreverTermoLP(b, modelo.custo[c], modelo.nomeColuna(c),
+                      c == primeiraComCusto);
+  });
+
+  saida.escrever(string("\nSubject To\n"));
+  emitirSecao(saida, modelo.numLinhas(), [&](int r, BufferModelo &b) {
+    b << " " << modelo.nomeLinha(r) << ": ";
+    // Linha sem termos (todos eliminados): o formato LP exige ao menos um,
+    // entao vai um 0 explicito e o solver ve a inviabilidade, se houver
+    if (modelo.inicioLinha[r] == modelo.inicioLinha[r + 1])
+      b << "0 " << modelo.nomeColuna(0);
+    for (size_t k = modelo.inicioLinha[r]; k < modelo.inicioLinha[r + 1];
+         k++) {
+      escreverTermoLP(b, modelo.coeficientes[k],
+                      modelo.nomeColuna(modelo.colunas[k]),
+                      k == modelo.inicioLinha[r]);
+    }
+    char s = modelo.sentido[r];
+    b << (s == 'L' ? " <= " : s == 'G' ? " >= " : " = ")
+      << modelo.ladoDireito[r] << "\n";
+  });
+
+  saida.escrever(string("Bounds\n"));
+  emitirSecao(saida, modelo.numColunas(), [&](int c, BufferModelo &b) {
+    double li = modelo.limiteInferior[c];
+    double ls = modelo.limiteSuperior[c];
+    if (modelo.binaria[c] && li == 0 && ls == 1)
+      return;
+    if (li == ls) {
+      b << " " << modelo.nomeColuna(c) << " = " << li << "\n";
+    } else if (isinf(ls)) {
+      b << " " << modelo.nomeColuna(c) << " >= " << li << "\n";
+    } else {
+      b << " " << li << " <= " << modelo.nomeColuna(c) << " <= " << ls
+        << "\n";
+    }
+  });
+
+  saida.escrever(string("Binary\n"));
+  emitirSecao(saida, modelo.numColunas(), [&](int c, BufferModelo &b) {
+    if (modelo.binaria[c])
+      b << " " << modelo.nomeColuna(c) << "\n";
+  });
+  saida.escrever(string("End\n"));
+}
+
+// MPS livre: COLUMNS exige os termos por coluna, entao a matriz CSR e
+// transposta antes da gravacao.
+static void gravarMPS(const ModeloMIP &modelo, SaidaModelo &saida) {
+  int numColunas = modelo.numColunas();
+  vector<size_t> inicioColuna(numColunas + 1, 0);
+  for (int c : modelo.colunas)
+    inicioColuna[c + 1]++;
+  for (int c = 0; c < numColunas; c++)
+    inicioColuna[c + 1] += inicioColuna[c];
+  vector<int> linhasColuna(modelo.numNaoNulos());
+  vector<double> coefColuna(modelo.numNaoNulos());
+  {
+    vector<size_t> proximo(inicioColuna.begin(), inicioColuna.end() - 1);
+    for (int r = 0; r < modelo.numLinhas(); r++) {
+      for (size_t k = modelo.inicioLinha[r]; k < modelo.inicioLinha[r + 1];
+           k++) {
+        size_t destino = proximo[modelo.colunas[k]]++;
+        linhasColuna[destino] = r;
+        coefColuna[destino] = modelo.coeficientes[k];
+      }
+    }
+  }
+
+  BufferModelo inicio;
+  inicio << "NAME " << string_view(modelo.nome.empty() ? "EVRP" : modelo.nome)
+         << "\nROWS\n N obj\n";
+  saida.escrever(inicio.dados);
+  emitirSecao(saida, modelo.numLinhas(), [&](int r, BufferModelo &b) {
+    char s[] = {' ', modelo.sentido[r], ' ', '\0'};
+    b << s << modelo.nomeLinha(r) << "\n";
+  });
+
+  saida.escrever(string("COLUMNS\n"));
+  emitirSecao(saida, numColunas, [&](int c, BufferModelo &b) {
+    bool binaria = modelo.binaria[c];
+    if (binaria && (c == 0 || !modelo.binaria[c - 1]))
+      b << " MARCADOR 'MARKER' 'INTORG'\n";
+    string_view nome = modelo.nomeColuna(c);
+    if (modelo.custo[c] != 0 || inicioColuna[c] == inicioColuna[c + 1])
+      b << " " << nome << " obj " << modelo.custo[c] << "\n";
+    // Ate dois pares (linha, coeficiente) por registro, como permite o MPS
+    for (size_t k = inicioColuna[c]; k < inicioColuna[c + 1]; k += 2) {
+      b << " " << nome << " " << modelo.nomeLinha(linhasColuna[k]) << " "
+        << coefColuna[k];
+      if (k + 1 < inicioColuna[c + 1])
+        b << " " << modelo.nomeLinha(linhasColuna[k + 1]) << " "
+          << coefColuna[k + 1];
+      b << "\n";
+    }
+    if (binaria && (c + 1 == numColunas || !modelo.binaria[c + 1]))
+      b << " MARCADOR 'MARKER' 'INTEND'\n";
+  });
+
+  saida.escrever(string("RHS\n"));
+  emitirSecao(saida, modelo.numLinhas(), [&](int r, BufferModelo &b) {
+    if (modelo.ladoDireito[r] != 0)
+      b << " RHS " << modelo.nomeLinha(r) << " " << modelo.ladoDireito[r]
+        << "\n";
+  });
+
+  saida.escrever(string("BOUNDS\n"));
+  emitirSecao(saida, numColunas, [&](int c, BufferModelo &b) {
+    double li = modelo.limiteInferior[c];
+    double ls = modelo.limiteSuperior[c];
+    string_view nome = modelo.nomeColuna(c);
+    if (modelo.binaria[c] && li == 0 && ls == 1) {
+      b << " BV BND " << nome << "\n";
+    } else if (li == ls) {
+      b << " FX BND " << nome << " " << li << "\n";
+    } else {
+      if (li != 0)
+        b << " LO BND " << nome << " " << li << "\n";
+      if (!isinf(ls))
+        b << " UP BND " << nome << " " << ls << "\n";
+    }
+  });
+  saida.escrever(string("ENDATA\n"));
+}
+
+bool gravarModelo(const ModeloMIP &modelo, const string &arquivo,
+                  const string &formato, const string &primeiraLinha) {
+  bool comprimir =
+      formato.size() > 3 && formato.compare(formato.size() - 3, 3, ".gz") == 0;
+  bool mps = formato.compare(0, 3, "mps") == 0;
+
+  SaidaModelo saida;
+  if (comprimir) {
+    // Nivel 1: a compressao e sequencial e nao deve dominar a exportacao
+    saida.comprimido = gzopen(arquivo.c_str(), "wb1");
+    if (!saida.comprimido)
+      return false;
+    gzbuffer(saida.comprimido, 1 << 20);
+  } else {
+    saida.arquivo = fopen(arquivo.c_str(), "wb");
+    if (!saida.arquivo)
+      return false;
+  }
+
+  saida.escrever(primeiraLinha);
+  if (mps)
+    gravarMPS(modelo, saida);
+  else
+    gravarLP(modelo, saida);
+
+  bool fechado = comprimir ? gzclose(saida.comprimido) == Z_OK
+                           : fclose(saida.arquivo) == 0;
+  return fechado && !saida.erro;
+}
+
+bool valoresInicioMIP(const ModeloMIP &modelo, const InstanciaEVRP &instancia,
+                      const vector<vector<int>> &rotas,
+                      vector<double> &valores) {
+  int n = instancia.dimensao;
+  int estacoes = instancia.estacoes;
+  double h = instancia.consumoEnergia;
+  double Q = instancia.capacidadeEnergia;
+  double C = instancia.capacidade;
+
+  shared_ptr<const MatrizDistancia> matriz = instancia.distancias;
+  if (!matriz) {
+    auto construida = make_shared<MatrizDistancia>();
+    construirMatrizDistancia(instancia, *construida);
+    matriz = construida;
+  }
+  const MatrizDistancia &dist = *matriz;
+
+  // Copias nao usadas ficam com y = u = 0, que satisfaz c5-c7 com x = 0
+  valores.assign(modelo.numColunas(), 0.0);
+  valores[modelo.colunaU(0)] = C;
+
+  vector<int> proximaCopia(estacoes, 0);
+  for (const auto &original : rotas) {
+    vector<int> rota = original;
+    for (int &no : rota) {
+      if (no >= n) {
+        int e = (no - n) % estacoes;
+        no = n + e + proximaCopia[e]++ * estacoes;
+        if (no >= modelo.totalNos)
+          return false;
+      }
+    }
+
+    double energia = Q;
+    double carga = C;
+    for (size_t k = 0; k + 1 < rota.size(); k++) {
+      int i = rota[k];
+      int j = rota[k + 1];
+      if (i == j)
+        continue;
+      int coluna = modelo.colunaX(i, j);
+      if (coluna < 0)
+        return false;
+      valores[coluna] = 1;
+
+      energia -= h * dist[i][j];
+      if (j == 0)
+        continue;
+      carga -= instancia.tabelas.demanda.empty()
+                   ? getDemandaByNodeId(instancia,
+                                        getNoByIndex(instancia, j).id)
+                   : instancia.tabelas.demanda[j];
+      valores[modelo.colunaY(j)] = energia;
+      valores[modelo.colunaU(j)] = carga;
+      if (j >= n)
+        energia = Q;
+    }
+  }
+  return true;
+}
+
+bool gravarInicioMIP(const ModeloMIP &modelo, const vector<double> &valores,
+                     const string &arquivo) {
+  FILE *f = fopen(arquivo.c_str(), "wb");
+  if (!f)
+    return false;
+
+  double objetivo = 0;
+  for (int c = 0; c < modelo.numColunas(); c++)
+    objetivo += modelo.custo[c] * valores[c];
+
+  bool xml = arquivo.size() >= 4 &&
+             arquivo.compare(arquivo.size() - 4, 4, ".mst") == 0;
+  if (xml) {
+    fprintf(f,
+            "<?xml version = \"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+            "<CPLEXSolutions version=\"1.2\">\n"
+            " <CPLEXSolution version=\"1.2\">\n"
+            "  <header\n"
+            "    problemName=\"%s\"\n"
+            "    solutionName=\"grasp\"\n"
+            "    solutionIndex=\"-1\"\n"
+            "    objectiveValue=\"%.17g\"/>\n"
+            "  <variables>\n",
+            modelo.nome.c_str(), objetivo);
+  } else {
+    fprintf(f, "# Solution for model %s\n# Objective value = %.17g\n",
+            modelo.nome.c_str(), objetivo);
+  }
+
+  BufferModelo b;
+  for (int c = 0; c < modelo.numColunas(); c++) {
+    char tmp[64];
+    double v = valores[c];
+    auto r = v == floor(v) && fabs(v) < 1e15
+                 ? to_chars(tmp, tmp + sizeof(tmp), static_cast<long long>(v))
+                 : to_chars(tmp, tmp + sizeof(tmp), v);
+    string_view valor(tmp, r.ptr - tmp);
+    if (xml)
+      b << "   <variable name=\"" << modelo.nomeColuna(c) << "\" value=\""
+        << valor << "\"/>\n";
+    else
+      b << modelo.nomeColuna(c) << " " << valor << "\n";
+    if (b.dados.size() > (1 << 20)) {
+      fwrite(b.dados.data(), 1, b.dados.size(), f);
+      b.dados.clear();
+    }
+  }
+  if (xml)
+    b << "  </variables>\n </CPLEXSolution>\n</CPLEXSolutions>\n";
+  fwrite(b.dados.data(), 1, b.dados.size(), f);
+  return fclose(f) == 0;
+}
+
+bool lerInicioMIP(const ModeloMIP &modelo, const string &arquivo,
+                  vector<double> &valores) {
+  ifstream entrada(arquivo);
+  if (!entrada)
+    return false;
+
+  unordered_map<string_view, int> coluna;
+  coluna.reserve(modelo.numColunas());
+  for (int c = 0; c < modelo.numColunas(); c++)
+    coluna[modelo.nomeColuna(c)] = c;
+
+  valores.assign(modelo.numColunas(), numeric_limits<double>::quiet_NaN());
+  auto atribuir = [&](string_view nome, string_view valor) {
+    auto it = coluna.find(nome);
+    if (it == coluna.end())
+      return;
+    double v = 0;
+    from_chars(valor.data(), valor.data() + valor.size(), v);
+    valores[it->second] = v;
+  };
+
+  // Atributo nome="valor" de um elemento XML
+  auto atributo = [](string_view linha, const char *nome) {
+    string chave = string(" ") + nome + "=\"";
+    size_t p = linha.find(chave);
+    if (p == string_view::npos)
+      return string_view();
+    p += chave.size();
+    size_t fim = linha.find('"', p);
+    return linha.substr(p, fim == string_view::npos ? string_view::npos
+                                                     : fim - p);
+  };
+
+  string linha;
+  while (getline(entrada, linha)) {
+    string_view l(linha);
+    if (l.find("<variable ") != string_view::npos) {
+      atribuir(atributo(l, "name"), atributo(l, "value"));
+      continue;
+    }
+    size_t inicio = l.find_first_not_of(" \t\r");
+    if (inicio == string_view::npos || l[inicio] == '#' || l[inicio] == '<')
+      continue;
+    l = l.substr(inicio);
+    size_t espaco = l.find_first_of(" \t");
+    if (espaco == string_view::npos)
+      continue;
+    string_view valor = l.substr(espaco);
+    valor = valor.substr(min(valor.size(), valor.find_first_not_of(" \t")));
+    atribuir(l.substr(0, espaco), valor);
+  }
+  return true;
+}
+
+bool verificarInicioMIP(const ModeloMIP &modelo, const vector<double> &valores,
+                        bool verbose, double tolerancia) {
+  const int maxMensagens = 10;
+  int violacoes = 0;
+  auto reportar = [&](const string &msg) {
+    if (verbose && violacoes < maxMensagens)
+      cerr << "  " << msg << endl;
+    violacoes++;
+  };
+
+  int semValor = 0;
+  double objetivo = 0;
+  for (int c = 0; c < modelo.numColunas(); c++) {
+    double v = valores[c];
+    if (std::isnan(v)) {
+      semValor++;
+      continue;
+    }
+    objetivo += modelo.custo[c] * v;
+    if (v < modelo.limiteInferior[c] - tolerancia ||
+        v > modelo.limiteSuperior[c] + tolerancia)
+      reportar(string(modelo.nomeColuna(c)) + " = " + to_string(v) +
+               " fora de [" + to_string(modelo.limiteInferior[c]) + ", " +
+               to_string(modelo.limiteSuperior[c]) + "]");
+    if (modelo.binaria[c] && fabs(v - round(v)) > tolerancia)
+      reportar(string(modelo.nomeColuna(c)) + " = " + to_string(v) +
+               " nao e inteiro");
+  }
+  if (semValor > 0) {
+    if (verbose)
+      cerr << "Erro: " << semValor << " variaveis sem valor no inicio MIP"
+           << endl;
+    return false;
+  }
+
+  for (int r = 0; r < modelo.numLinhas(); r++) {
+    double lhs = 0;
+    for (size_t k = modelo.inicioLinha[r]; k < modelo.inicioLinha[r + 1]; k++)
+      lhs += modelo.coeficientes[k] * valores[modelo.colunas[k]];
+    double rhs = modelo.ladoDireito[r];
+    char s = modelo.sentido[r];
+    if ((s != 'G' && lhs > rhs + tolerancia) ||
+        (s != 'L' && lhs < rhs - tolerancia)) {
+      reportar(string(modelo.nomeLinha(r)) + ": " + to_string(lhs) +
+               (s == 'L' ? " <= " : s == 'G' ? " >= " : " = ") +
+               to_string(rhs) + " violada");
+    }
+  }
+
+  if (verbose) {
+    if (violacoes > maxMensagens)
+      cerr << "  ... e mais " << violacoes - maxMensagens << " violacoes"
+           << endl;
+    cout << "Inicio MIP " << (violacoes == 0 ? "viavel" : "inviavel")
+         << ": objetivo " << fixed << setprecision(6) << objetivo << ", "
+         << violacoes << " violacoes" << endl;
+  }
+  return violacoes == 0;
+}
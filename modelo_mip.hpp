@@ -0,0 +1,111 @@
+#ifndef MODELO_MIP_HPP
+#define MODELO_MIP_HPP
+
+#include "utils.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Modelo MIP esparso em memoria, independente do formato de arquivo: linhas
+// em CSR (termos da linha r em [inicioLinha[r], inicioLinha[r+1])), colunas
+// com custo, limites e tipo. Nomes ficam concatenados em um unico buffer.
+struct ModeloMIP {
+  string nome;
+
+  vector<double> custo;
+  vector<double> limiteInferior;
+  vector<double> limiteSuperior;
+  vector<char> binaria;
+
+  vector<size_t> inicioLinha{0};
+  vector<int> colunas;
+  vector<double> coeficientes;
+  vector<char> sentido;  // 'L' (<=), 'G' (>=) ou 'E' (=)
+  vector<double> ladoDireito;
+
+  // Linhas de um unico termo convertidas em limites da coluna
+  int linhasDobradas = 0;
+
+  // Indices das variaveis do EVRP: x_i_j (-1 se o arco foi eliminado),
+  // y_i e u_i para i em 0..totalNos-1
+  int totalNos = 0;
+  vector<int> colunaArco;
+  int inicioY = 0;
+  int inicioU = 0;
+
+  int numColunas() const { return static_cast<int>(custo.size()); }
+  int numLinhas() const { return static_cast<int>(sentido.size()); }
+  size_t numNaoNulos() const { return colunas.size(); }
+
+  int colunaX(int i, int j) const {
+    return colunaArco[static_cast<size_t>(i) * totalNos + j];
+  }
+  int colunaY(int i) const { return inicioY + i; }
+  int colunaU(int i) const { return inicioU + i; }
+
+  string_view nomeColuna(int c) const {
+    return string_view(nomesColunas).substr(
+        inicioNomeColuna[c], inicioNomeColuna[c + 1] - inicioNomeColuna[c]);
+  }
+  string_view nomeLinha(int r) const {
+    return string_view(nomesLinhas).substr(
+        inicioNomeLinha[r], inicioNomeLinha[r + 1] - inicioNomeLinha[r]);
+  }
+
+  int adicionarColuna(string_view nomeCol, double custoCol, double inferior,
+                      double superior, bool binariaCol);
+  void adicionarTermo(int coluna, double coeficiente) {
+    colunas.push_back(coluna);
+    coeficientes.push_back(coeficiente);
+  }
+  // Fecha a linha com os termos adicionados desde a anterior. Linhas com um
+  // unico termo viram limites da coluna; retorna false nesse caso.
+  bool fecharLinha(string_view nomeLin, char sentidoLin, double lado);
+
+private:
+  string nomesColunas;
+  vector<size_t> inicioNomeColuna{0};
+  string nomesLinhas;
+  vector<size_t> inicioNomeLinha{0};
+};
+
+// Contagens do pre-processamento feito ao montar o modelo do EVRP
+struct EstatisticasModelo {
+  long long arcosRemovidos = 0;
+  long long restricoesRemovidas = 0;
+  int cortesAdicionados = 0;
+};
+
+// Formulacao do EVRP (mesma do exportador LP) montada em memoria
+void construirModeloEVRP(const InstanciaEVRP &instancia, const OpcoesLP &opcoes,
+                         ModeloMIP &modelo,
+                         EstatisticasModelo *estatisticas = nullptr);
+
+// Grava o modelo em LP ou MPS livre, com gzip quando formato termina em
+// ".gz". primeiraLinha (ja com o marcador de comentario) abre o arquivo.
+bool gravarModelo(const ModeloMIP &modelo, const string &arquivo,
+                  const string &formato, const string &primeiraLinha);
+
+// Inicio MIP (MIP start) a partir de rotas no formato do GRASP: x dos arcos
+// percorridos, y = energia na chegada e u = carga restante apos cada no.
+// As copias de cada estacao fisica sao renumeradas na ordem de uso, como
+// exigem os cortes de simetria. Retorna false se alguma rota usa um arco
+// ausente do modelo.
+bool valoresInicioMIP(const ModeloMIP &modelo, const InstanciaEVRP &instancia,
+                      const vector<vector<int>> &rotas, vector<double> &valores);
+
+// .mst: XML do CPLEX; qualquer outra extensao (.sol): "nome valor" por
+// linha, lido pelo Gurobi
+bool gravarInicioMIP(const ModeloMIP &modelo, const vector<double> &valores,
+                     const string &arquivo);
+// Colunas ausentes do arquivo ficam com NaN
+bool lerInicioMIP(const ModeloMIP &modelo, const string &arquivo,
+                  vector<double> &valores);
+
+// Confere limites, integralidade e todas as linhas do modelo, sem solver
+bool verificarInicioMIP(const ModeloMIP &modelo, const vector<double> &valores,
+                        bool verbose = true, double tolerancia = 1e-6);
+
+#endif
@@ -0,0 +1,229 @@
+#include "progresso.hpp"
+#include "json.hpp"
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+atomic<bool> progressoAtivo{false};
+
+struct AtividadeProgresso {
+  string instancia;
+  string solver;
+  long long semente = -1;
+  int thread = 0;
+  chrono::steady_clock::time_point inicio;
+  atomic<double> incumbente{INFINITY};
+  atomic<double> limite{NAN};
+  atomic<long long> iteracoes{0};
+  atomic<int64_t> nanosMelhora{-1}; // desde inicio; -1 = sem solucao ainda
+};
+
+static mutex travaAtividades;
+static vector<shared_ptr<AtividadeProgresso>> atividades;
+static atomic<int> proximaThread{0};
+static thread_local int idThread = -1;
+
+static string arquivoStatus;
+static double intervaloStatus = 1.0;
+static thread threadStatus;
+static mutex travaParada;
+static condition_variable sinalParada;
+static bool pararStatus = false;
+
+static double segundosDesde(chrono::steady_clock::time_point inicio) {
+  return chrono::duration<double>(chrono::steady_clock::now() - inicio)
+      .count();
+}
+
+RegistroProgresso::RegistroProgresso(const string &instancia,
+                                     const string &solver,
+                                     long long semente) {
+  if (!progressoAtivo.load(memory_order_relaxed))
+    return;
+  if (idThread < 0)
+    idThread = ++proximaThread;
+  atividade = make_shared<AtividadeProgresso>();
+  atividade->instancia = instancia;
+  atividade->solver = solver;
+  atividade->semente = semente;
+  atividade->thread = idThread;
+  atividade->inicio = chrono::steady_clock::now();
+  lock_guard<mutex> guarda(travaAtividades);
+  atividades.push_back(atividade);
+}
+
+RegistroProgresso::~RegistroProgresso() {
+  if (!atividade)
+    return;
+  lock_guard<mutex> guarda(travaAtividades);
+  for (size_t k = 0; k < atividades.size(); k++) {
+    if (atividades[k] == atividade) {
+      atividades.erase(atividades.begin() + k);
+      break;
+    }
+  }
+}
+
+void RegistroProgresso::iteracoes(long long total) {
+  if (atividade)
+    atividade->iteracoes.store(total, memory_order_relaxed);
+}
+
+void RegistroProgresso::incumbente(double custo) {
+  if (!atividade || custo >= 1e19)
+    return;
+  double atual = atividade->incumbente.load(memory_order_relaxed);
+  while (custo < atual) {
+    if (atividade->incumbente.compare_exchange_weak(atual, custo,
+                                                    memory_order_relaxed)) {
+      atividade->nanosMelhora.store(
+          chrono::duration_cast<chrono::nanoseconds>(
+              chrono::steady_clock::now() - atividade->inicio)
+              .count(),
+          memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+void RegistroProgresso::limite(double valor) {
+  if (atividade && valor < 1e19)
+    atividade->limite.store(valor, memory_order_relaxed);
+}
+
+// Amostra anterior de cada atividade, para a taxa de iteracoes por segundo
+struct AmostraProgresso {
+  long long iteracoes;
+  double tempo;
+};
+
+static string statusJSON(map<const AtividadeProgresso *, AmostraProgresso>
+                             &amostras) {
+  vector<shared_ptr<AtividadeProgresso>> copia;
+  {
+    lock_guard<mutex> guarda(travaAtividades);
+    copia = atividades;
+  }
+
+  EscritorJSON j;
+  j.abrirObjeto();
+  j.chave("pid");
+  j.valor(static_cast<long long>(getpid()));
+  j.chave("atividades");
+  j.abrirLista();
+  map<const AtividadeProgresso *, AmostraProgresso> novas;
+  for (const auto &a : copia) {
+    double tempo = segundosDesde(a->inicio);
+    long long iteracoes = a->iteracoes.load(memory_order_relaxed);
+    double incumbente = a->incumbente.load(memory_order_relaxed);
+    double limite = a->limite.load(memory_order_relaxed);
+    int64_t nanosMelhora = a->nanosMelhora.load(memory_order_relaxed);
+
+    // Taxa desde a gravacao anterior (ou desde o inicio, na primeira)
+    AmostraProgresso anterior = {0, 0};
+    auto it = amostras.find(a.get());
+    if (it != amostras.end())
+      anterior = it->second;
+    novas[a.get()] = {iteracoes, tempo};
+    double intervalo = tempo - anterior.tempo;
+
+    j.abrirObjeto();
+    j.chave("instancia");
+    j.valor(a->instancia);
+    j.chave("solver");
+    j.valor(a->solver);
+    if (a->semente >= 0) {
+      j.chave("semente");
+      j.valor(a->semente);
+    }
+    j.chave("thread");
+    j.valor(a->thread);
+    j.chave("tempo");
+    j.valor(tempo);
+    j.chave("iteracoes");
+    j.valor(iteracoes);
+    j.chave("iter_s");
+    j.valor(intervalo > 0 ? (iteracoes - anterior.iteracoes) / intervalo
+                          : 0.0);
+    j.chave("incumbente");
+    if (isfinite(incumbente))
+      j.valor(incumbente);
+    else
+      j.valorNulo();
+    j.chave("limite");
+    if (isfinite(limite))
+      j.valor(limite);
+    else
+      j.valorNulo();
+    j.chave("gap");
+    if (isfinite(incumbente) && isfinite(limite) && incumbente != 0)
+      j.valor((incumbente - limite) / fabs(incumbente) * 100.0);
+    else
+      j.valorNulo();
+    j.chave("desde_melhora");
+    if (nanosMelhora >= 0)
+      j.valor(tempo - nanosMelhora / 1e9);
+    else
+      j.valorNulo();
+    j.fecharObjeto();
+  }
+  j.fecharLista();
+  j.fecharObjeto();
+  amostras.swap(novas);
+  return j.saida;
+}
+
+// Grava em um temporario e renomeia: quem le nunca ve um arquivo pela metade
+static bool gravarStatus(const string &conteudo) {
+  string temporario = arquivoStatus + ".tmp";
+  {
+    ofstream saida(temporario);
+    saida << conteudo << "\n";
+    if (!saida)
+      return false;
+  }
+  return rename(temporario.c_str(), arquivoStatus.c_str()) == 0;
+}
+
+bool iniciarProgresso(const string &arquivo, double intervalo) {
+  arquivoStatus = arquivo;
+  intervaloStatus = intervalo > 0 ? intervalo : 1.0;
+  pararStatus = false;
+  map<const AtividadeProgresso *, AmostraProgresso> vazio;
+  if (!gravarStatus(statusJSON(vazio)))
+    return false;
+  progressoAtivo.store(true);
+
+  threadStatus = thread([]() {
+    map<const AtividadeProgresso *, AmostraProgresso> amostras;
+    unique_lock<mutex> trava(travaParada);
+    while (!pararStatus) {
+      sinalParada.wait_for(trava, chrono::duration<double>(intervaloStatus));
+      if (!pararStatus)
+        gravarStatus(statusJSON(amostras));
+    }
+  });
+  return true;
+}
+
+void pararProgresso() {
+  if (!threadStatus.joinable())
+    return;
+  {
+    lock_guard<mutex> guarda(travaParada);
+    pararStatus = true;
+  }
+  sinalParada.notify_all();
+  threadStatus.join();
+  map<const AtividadeProgresso *, AmostraProgresso> amostras;
+  gravarStatus(statusJSON(amostras));
+  progressoAtivo.store(false);
+}
@@ -0,0 +1,47 @@
+#ifndef PROGRESSO_HPP
+#define PROGRESSO_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+// Arquivo de status reescrito periodicamente (--status=) com cada execucao
+// em andamento: incumbente, limite (MIP), iteracoes (ou nos) por segundo e
+// tempo desde a ultima melhora, por thread. A troca e atomica (rename), entao
+// um escalonador pode le-lo a qualquer momento para encerrar execucoes
+// estagnadas. Desligado, registrar uma execucao custa uma leitura atomica.
+extern atomic<bool> progressoAtivo;
+
+// Inicia a thread que reescreve arquivo a cada intervalo segundos
+bool iniciarProgresso(const string &arquivo, double intervalo = 1.0);
+// Grava o estado final e encerra a thread
+void pararProgresso();
+
+struct AtividadeProgresso;
+
+// Uma execucao acompanhada, registrada enquanto o objeto existir. As
+// atualizacoes sao atomicas e podem vir de qualquer thread (callbacks MIP).
+class RegistroProgresso {
+public:
+  RegistroProgresso(const string &instancia, const string &solver,
+                    long long semente = -1);
+  ~RegistroProgresso();
+  RegistroProgresso(const RegistroProgresso &) = delete;
+  RegistroProgresso &operator=(const RegistroProgresso &) = delete;
+
+  bool ativo() const { return atividade != nullptr; }
+  // Iteracoes do GRASP ou nos do branch-and-bound feitos ate agora
+  void iteracoes(long long total);
+  // Valores >= 1e19 (sem solucao ou sem limite) sao ignorados
+  void incumbente(double custo);
+  void limite(double valor);
+
+private:
+  shared_ptr<AtividadeProgresso> atividade;
+};
+
+#endif
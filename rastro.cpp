@@ -0,0 +1,131 @@
+#include "rastro.hpp"
+#include "json.hpp"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+atomic<bool> rastroAtivo{false};
+
+struct EventoRastro {
+  const char *nome;
+  const char *chave;
+  double valor;
+  int64_t nanos; // desde iniciarRastro
+  char fase;
+};
+
+// Buffer de uma thread: so ela escreve; a leitura acontece em gravarRastro,
+// depois que as threads terminaram
+struct BufferRastro {
+  int tid;
+  vector<EventoRastro> eventos;
+  uint64_t escritos = 0;
+};
+
+static mutex travaBuffers;
+static vector<unique_ptr<BufferRastro>> buffers; // sobrevivem as threads
+static size_t capacidadeBuffer = 0;
+static chrono::steady_clock::time_point inicioRastro;
+static thread_local BufferRastro *bufferThread = nullptr;
+
+void iniciarRastro(size_t eventosPorThread) {
+  lock_guard<mutex> guarda(travaBuffers);
+  capacidadeBuffer = eventosPorThread > 0 ? eventosPorThread : 1;
+  inicioRastro = chrono::steady_clock::now();
+  rastroAtivo.store(true);
+}
+
+void registrarEvento(const char *nome, char fase, const char *chave,
+                     double valor) {
+  BufferRastro *b = bufferThread;
+  if (!b) {
+    // Primeiro evento da thread: unica passagem pela trava
+    lock_guard<mutex> guarda(travaBuffers);
+    buffers.emplace_back(new BufferRastro());
+    b = buffers.back().get();
+    b->tid = static_cast<int>(buffers.size());
+    b->eventos.resize(capacidadeBuffer);
+    bufferThread = b;
+  }
+  EventoRastro &e = b->eventos[b->escritos % b->eventos.size()];
+  e.nome = nome;
+  e.chave = chave;
+  e.valor = valor;
+  e.nanos = chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - inicioRastro)
+                .count();
+  e.fase = fase;
+  b->escritos++;
+}
+
+bool gravarRastro(const string &arquivo) {
+  lock_guard<mutex> guarda(travaBuffers);
+  ofstream saida(arquivo);
+  if (!saida)
+    return false;
+
+  long long descartados = 0;
+  bool primeiro = true;
+  saida << "{\"traceEvents\":[\n";
+  for (const auto &b : buffers) {
+    EscritorJSON j;
+    j.abrirObjeto();
+    j.chave("name");
+    j.valor("thread_name");
+    j.chave("ph");
+    j.valor("M");
+    j.chave("pid");
+    j.valor(1);
+    j.chave("tid");
+    j.valor(b->tid);
+    j.chave("args");
+    j.abrirObjeto();
+    j.chave("name");
+    j.valor("thread " + to_string(b->tid));
+    j.fecharObjeto();
+    j.fecharObjeto();
+    saida << (primeiro ? "" : ",\n") << j.saida;
+    primeiro = false;
+
+    // Buffer que deu a volta: comeca pelo evento mais antigo que sobrou
+    uint64_t capacidade = b->eventos.size();
+    uint64_t inicio = b->escritos > capacidade ? b->escritos - capacidade : 0;
+    descartados += inicio;
+    for (uint64_t k = inicio; k < b->escritos; k++) {
+      const EventoRastro &e = b->eventos[k % capacidade];
+      EscritorJSON ev;
+      ev.abrirObjeto();
+      ev.chave("name");
+      ev.valor(e.nome);
+      ev.chave("ph");
+      ev.valor(string_view(&e.fase, 1));
+      ev.chave("ts");
+      ev.valor(e.nanos / 1000.0);
+      ev.chave("pid");
+      ev.valor(1);
+      ev.chave("tid");
+      ev.valor(b->tid);
+      if (e.fase == 'i') {
+        ev.chave("s");
+        ev.valor("t");
+      }
+      if (e.chave) {
+        ev.chave("args");
+        ev.abrirObjeto();
+        ev.chave(e.chave);
+        ev.valor(e.valor);
+        ev.fecharObjeto();
+      }
+      ev.fecharObjeto();
+      saida << ",\n" << ev.saida;
+    }
+  }
+  saida << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{"
+        << "\"eventos_descartados\":" << descartados << "}}\n";
+  return static_cast<bool>(saida);
+}
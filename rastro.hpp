@@ -0,0 +1,50 @@
+#ifndef RASTRO_HPP
+#define RASTRO_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// Rastro de execucao no formato Chrome trace-event, para abrir em
+// chrome://tracing ou ui.perfetto.dev. Cada thread grava em um buffer
+// circular proprio, sem travas (quando enche, os eventos mais antigos sao
+// sobrescritos). Desligado, cada evento custa so a leitura de rastroAtivo.
+extern atomic<bool> rastroAtivo;
+
+// Liga o rastro; chamar antes de iniciar as threads que serao rastreadas
+void iniciarRastro(size_t eventosPorThread = 1 << 18);
+
+// fase: 'B' (inicio), 'E' (fim) ou 'i' (instantaneo). nome e chave devem
+// ser literais: so o ponteiro e guardado.
+void registrarEvento(const char *nome, char fase, const char *chave = nullptr,
+                     double valor = 0);
+
+// Grava os eventos de todas as threads; chamar depois que elas terminarem
+bool gravarRastro(const string &arquivo);
+
+inline void eventoRastro(const char *nome, const char *chave = nullptr,
+                         double valor = 0) {
+  if (rastroAtivo.load(memory_order_relaxed))
+    registrarEvento(nome, 'i', chave, valor);
+}
+
+// Evento de duracao: inicio na construcao, fim na destruicao
+struct EscopoRastro {
+  const char *nome;
+  bool ativo;
+
+  explicit EscopoRastro(const char *nome, const char *chave = nullptr,
+                        double valor = 0)
+      : nome(nome), ativo(rastroAtivo.load(memory_order_relaxed)) {
+    if (ativo)
+      registrarEvento(nome, 'B', chave, valor);
+  }
+  ~EscopoRastro() {
+    if (ativo)
+      registrarEvento(nome, 'E');
+  }
+};
+
+#endif
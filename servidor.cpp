@@ -0,0 +1,372 @@
+#include "servidor.hpp"
+#include "contexto_solver.hpp"
+#include "json.hpp"
+#include "solucao_io.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+struct EstadoServidor {
+  GRASPParams base;
+  CatalogoContextos contextos; // instancias e matrizes mantidas entre pedidos
+  atomic<bool> encerrar{false};
+  atomic<int> conexoes{0};
+  atomic<long long> ultimaAtividade{0}; // ms desde o inicio do servidor
+  chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+
+  long long agora() const {
+    return chrono::duration_cast<chrono::milliseconds>(
+               chrono::steady_clock::now() - inicio)
+        .count();
+  }
+};
+
+struct PedidoServidor {
+  string id;            // JSON literal, ecoado na resposta
+  bool idTexto = false; // id veio como string
+  string comando;
+  string instancia;
+  GRASPParams params;
+  bool incluirRotas = false;
+  string arquivoSolucao;
+};
+
+static bool lerPedido(const string &linha, PedidoServidor &pedido,
+                      string &erro) {
+  LeitorJSON j(linha);
+  if (!j.esperar('{')) {
+    erro = "pedido deve ser um objeto JSON";
+    return false;
+  }
+  if (j.consumir('}'))
+    return true;
+
+  GRASPParams &p = pedido.params;
+  string chave;
+  do {
+    if (!j.lerString(chave) || !j.esperar(':'))
+      break;
+    long long inteiro;
+    if (chave == "id") {
+      j.pularBrancos();
+      if (j.pos < j.texto.size() && j.texto[j.pos] == '"') {
+        pedido.idTexto = true;
+        j.lerString(pedido.id);
+      } else if (j.lerInteiro(inteiro)) {
+        pedido.id = to_string(inteiro);
+      }
+    } else if (chave == "comando") {
+      j.lerString(pedido.comando);
+    } else if (chave == "instancia") {
+      j.lerString(pedido.instancia);
+    } else if (chave == "seed") {
+      if (j.lerInteiro(inteiro))
+        p.seed = static_cast<int>(inteiro);
+    } else if (chave == "alpha") {
+      j.lerNumero(p.alpha);
+    } else if (chave == "max_iter") {
+      if (j.lerInteiro(inteiro))
+        p.max_iter = static_cast<int>(inteiro);
+    } else if (chave == "max_avaliacoes") {
+      j.lerInteiro(p.max_avaliacoes);
+    } else if (chave == "tempo_limite") {
+      j.lerNumero(p.tempo_limite);
+    } else if (chave == "cache_reparo") {
+      if (j.lerInteiro(inteiro))
+        p.cache_reparo = static_cast<int>(inteiro);
+    } else if (chave == "filtro_duplicatas") {
+      j.lerBooleano(p.filtro_duplicatas);
+    } else if (chave == "alvo") {
+      j.lerNumero(p.alvo);
+    } else if (chave == "gap") {
+      j.lerNumero(p.gap);
+    } else if (chave == "estagnacao_iter") {
+      if (j.lerInteiro(inteiro))
+        p.estagnacao_iter = static_cast<int>(inteiro);
+    } else if (chave == "estagnacao_tempo") {
+      j.lerNumero(p.estagnacao_tempo);
+    } else if (chave == "construtor") {
+      j.lerString(p.construtor);
+    } else if (chave == "rotas") {
+      j.lerBooleano(pedido.incluirRotas);
+    } else if (chave == "arquivo_solucao") {
+      j.lerString(pedido.arquivoSolucao);
+    } else {
+      erro = "chave desconhecida: " + chave;
+      return false;
+    }
+    if (j.erro) {
+      erro = "valor invalido para " + chave;
+      return false;
+    }
+  } while (j.consumir(','));
+
+  if (!j.esperar('}') || !j.fim()) {
+    erro = "JSON malformado";
+    return false;
+  }
+  if (p.construtor != "vizinho" && p.construtor != "varredura" &&
+      p.construtor != "misto") {
+    erro = "construtor invalido: " + p.construtor;
+    return false;
+  }
+  if (!pedido.arquivoSolucao.empty() &&
+      !arquivoSolucaoEstruturado(pedido.arquivoSolucao)) {
+    erro = "arquivo_solucao deve terminar em .jsonl ou .evrpsol";
+    return false;
+  }
+  return true;
+}
+
+static void escreverId(EscritorJSON &j, const PedidoServidor &pedido) {
+  if (pedido.id.empty())
+    return;
+  j.chave("id");
+  if (pedido.idTexto)
+    j.valor(pedido.id);
+  else
+    j.valor(atoll(pedido.id.c_str()));
+}
+
+static string respostaErro(const PedidoServidor &pedido, const string &erro) {
+  EscritorJSON j;
+  j.abrirObjeto();
+  escreverId(j, pedido);
+  j.chave("ok");
+  j.valor(false);
+  j.chave("erro");
+  j.valor(erro);
+  j.fecharObjeto();
+  return move(j.saida);
+}
+
+static string processarPedido(EstadoServidor &estado, const string &linha) {
+  PedidoServidor pedido;
+  pedido.params = estado.base;
+  string erro;
+  if (!lerPedido(linha, pedido, erro))
+    return respostaErro(pedido, erro);
+
+  if (pedido.comando == "sair" || pedido.comando == "ping") {
+    if (pedido.comando == "sair")
+      estado.encerrar = true;
+    EscritorJSON j;
+    j.abrirObjeto();
+    escreverId(j, pedido);
+    j.chave("ok");
+    j.valor(true);
+    j.fecharObjeto();
+    return move(j.saida);
+  }
+  if (!pedido.comando.empty())
+    return respostaErro(pedido, "comando desconhecido: " + pedido.comando);
+  if (pedido.instancia.empty())
+    return respostaErro(pedido, "instancia ausente");
+
+  shared_ptr<const ContextoSolver> contexto =
+      estado.contextos.obter(pedido.instancia);
+  if (!contexto)
+    return respostaErro(pedido, "instancia nao encontrada: " +
+                                    nomeBaseInstancia(pedido.instancia));
+  const string &nome = contexto->nome;
+
+  GRASPParams &p = pedido.params;
+  p.verbose = false;
+  p.run_number = -1;
+  p.inicio_mip.clear();
+
+  ResultadoGRASP resultado;
+  try {
+    resultado = contexto->executarGRASP(p);
+  } catch (const exception &e) {
+    return respostaErro(pedido, e.what());
+  }
+  bool valida = !resultado.rotas.empty() && contexto->validar(resultado.rotas);
+
+  if (!pedido.arquivoSolucao.empty()) {
+    RegistroSolucao registro;
+    registro.instancia = nome;
+    registro.hashInstancia = contexto->hash;
+    registro.solver = "GRASP";
+    registro.custo = resultado.custo;
+    registro.tempo = resultado.tempo;
+    registro.tempoMelhor = resultado.tempoMelhor;
+    registro.seed = resultado.semente;
+    registro.rotas = resultado.rotas;
+    if (!anexarSolucao(pedido.arquivoSolucao, registro))
+      return respostaErro(pedido, "falha ao gravar " + pedido.arquivoSolucao);
+  }
+
+  EscritorJSON j;
+  j.abrirObjeto();
+  escreverId(j, pedido);
+  j.chave("ok");
+  j.valor(true);
+  j.chave("instancia");
+  j.valor(nome);
+  j.chave("custo");
+  j.valor(resultado.custo);
+  j.chave("valida");
+  j.valor(valida);
+  j.chave("tempo");
+  j.valor(resultado.tempo);
+  j.chave("tempo_melhor");
+  j.valor(resultado.tempoMelhor);
+  j.chave("iteracoes");
+  j.valor(resultado.iteracoes);
+  j.chave("iter_melhor");
+  j.valor(resultado.iterMelhor);
+  j.chave("semente");
+  j.valor(static_cast<long long>(resultado.semente));
+  j.chave("parada");
+  j.valor(resultado.motivoParada);
+  if (pedido.incluirRotas) {
+    j.chave("rotas");
+    j.abrirLista();
+    for (const auto &rota : resultado.rotas) {
+      j.abrirLista();
+      for (int no : rota)
+        j.valor(no);
+      j.fecharLista();
+    }
+    j.fecharLista();
+  }
+  j.fecharObjeto();
+  return move(j.saida);
+}
+
+static bool enviarTudo(int fd, const string &dados) {
+  size_t enviados = 0;
+  while (enviados < dados.size()) {
+    ssize_t r = send(fd, dados.data() + enviados, dados.size() - enviados,
+                     MSG_NOSIGNAL);
+    if (r <= 0)
+      return false;
+    enviados += r;
+  }
+  return true;
+}
+
+static void atenderConexao(shared_ptr<EstadoServidor> estado, int fd) {
+  string pendente;
+  char bloco[4096];
+  bool aberta = true;
+  while (aberta && !estado->encerrar) {
+    ssize_t lidos = read(fd, bloco, sizeof(bloco));
+    if (lidos <= 0)
+      break;
+    pendente.append(bloco, lidos);
+    size_t inicio = 0, fimLinha;
+    while ((fimLinha = pendente.find('\n', inicio)) != string::npos) {
+      string linha = pendente.substr(inicio, fimLinha - inicio);
+      inicio = fimLinha + 1;
+      if (linha.find_first_not_of(" \t\r") == string::npos)
+        continue;
+      string resposta = processarPedido(*estado, linha);
+      resposta += '\n';
+      if (!enviarTudo(fd, resposta) || estado->encerrar) {
+        aberta = false;
+        break;
+      }
+    }
+    pendente.erase(0, inicio);
+  }
+  close(fd);
+  estado->ultimaAtividade = estado->agora();
+  estado->conexoes--;
+}
+
+static int servirEntradaPadrao(EstadoServidor &estado) {
+  string linha;
+  while (!estado.encerrar && getline(cin, linha)) {
+    if (linha.find_first_not_of(" \t\r") == string::npos)
+      continue;
+    cout << processarPedido(estado, linha) << '\n' << flush;
+  }
+  return 0;
+}
+
+int executarServidor(const string &endereco, const GRASPParams &base,
+                     double ocioso) {
+  auto estado = make_shared<EstadoServidor>();
+  estado->base = base;
+
+  if (endereco.empty() || endereco == "-")
+    return servirEntradaPadrao(*estado);
+
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (endereco.size() >= sizeof(addr.sun_path)) {
+    cerr << "Erro: caminho do socket muito longo: " << endereco << endl;
+    return 1;
+  }
+  strcpy(addr.sun_path, endereco.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    cerr << "Erro: socket: " << strerror(errno) << endl;
+    return 1;
+  }
+
+  // Socket antigo: remove so se nenhum servidor estiver respondendo nele
+  struct stat info;
+  if (stat(endereco.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+    int teste = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool ativo = connect(teste, reinterpret_cast<sockaddr *>(&addr),
+                         sizeof(addr)) == 0;
+    close(teste);
+    if (ativo) {
+      cerr << "Erro: ja existe um servidor em " << endereco << endl;
+      close(fd);
+      return 1;
+    }
+    unlink(endereco.c_str());
+  }
+
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(fd, 64) < 0) {
+    cerr << "Erro: nao foi possivel escutar em " << endereco << ": "
+         << strerror(errno) << endl;
+    close(fd);
+    return 1;
+  }
+  cerr << "Servidor escutando em " << endereco << endl;
+
+  long long limiteOcioso = static_cast<long long>(ocioso * 1000);
+  while (!estado->encerrar) {
+    pollfd p = {fd, POLLIN, 0};
+    int r = poll(&p, 1, 200);
+    if (r < 0 && errno != EINTR)
+      break;
+    if (r <= 0) {
+      if (limiteOcioso > 0 && estado->conexoes == 0 &&
+          estado->agora() - estado->ultimaAtividade > limiteOcioso) {
+        cerr << "Servidor ocioso, encerrando" << endl;
+        break;
+      }
+      continue;
+    }
+    int cliente = accept(fd, nullptr, nullptr);
+    if (cliente < 0)
+      continue;
+    estado->conexoes++;
+    thread(atenderConexao, estado, cliente).detach();
+  }
+
+  close(fd);
+  unlink(endereco.c_str());
+  return 0;
+}
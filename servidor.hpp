@@ -0,0 +1,29 @@
+#ifndef SERVIDOR_HPP
+#define SERVIDOR_HPP
+
+#include "grasp_solver.hpp"
+#include <string>
+
+using namespace std;
+
+// Modo servidor (main --serve): processo de longa duracao que recebe
+// pedidos JSON, um por linha, e responde uma linha JSON por pedido.
+// Instancias e matrizes de distancia ficam em memoria entre pedidos.
+//
+// Pedido: {"id":7,"instancia":"E-n22-k4","seed":3,"alpha":0.3,
+//          "max_iter":1000,"tempo_limite":30,"construtor":"vizinho",...}
+//   chaves com os nomes dos campos de GRASPParams; ausentes usam os valores
+//   da linha de comando. "rotas":true inclui as rotas na resposta e
+//   "arquivo_solucao" anexa o registro em um .jsonl/.evrpsol.
+// Resposta: {"id":7,"ok":true,"custo":...,"tempo":...,"tempo_melhor":...,
+//            "iteracoes":...,"iter_melhor":...,"semente":...,"parada":"..."}
+//   ou {"id":7,"ok":false,"erro":"..."}.
+// {"comando":"sair"} encerra o servidor; {"comando":"ping"} so responde.
+//
+// endereco vazio ou "-": le stdin e escreve stdout (sequencial). Caso
+// contrario e o caminho de um socket Unix, com uma thread por conexao.
+// ocioso > 0 encerra o servidor apos esse numero de segundos sem conexoes.
+int executarServidor(const string &endereco, const GRASPParams &base,
+                     double ocioso = 0);
+
+#endif
@@ -0,0 +1,280 @@
+#include "solucao_io.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct CabecalhoRegistroSolucao {
+  char magica[4];
+  uint32_t versao;
+  uint64_t hashInstancia;
+  double custo;
+  double tempo;
+  double tempoMelhor;
+  int64_t seed;
+  int32_t run;
+  uint32_t numRotas;
+  uint32_t totalNos;
+  uint16_t tamInstancia;
+  uint16_t tamSolver;
+};
+static_assert(sizeof(CabecalhoRegistroSolucao) == 64,
+              "cabecalho binario deve ter layout fixo");
+
+static const char MAGICA_SOLUCAO[4] = {'E', 'V', 'S', 'L'};
+
+bool arquivoSolucaoEstruturado(const string &arquivo) {
+  auto termina = [&](const char *sufixo) {
+    size_t tam = strlen(sufixo);
+    return arquivo.size() >= tam &&
+           arquivo.compare(arquivo.size() - tam, tam, sufixo) == 0;
+  };
+  return termina(".jsonl") || termina(".evrpsol");
+}
+
+static void serializarJSON(const RegistroSolucao &r, string &saida) {
+  char hash[17];
+  snprintf(hash, sizeof(hash), "%016" PRIx64, r.hashInstancia);
+
+  EscritorJSON j;
+  j.abrirObjeto();
+  j.chave("instancia");
+  j.valor(r.instancia);
+  j.chave("hash");
+  j.valor(hash);
+  j.chave("solver");
+  j.valor(r.solver);
+  j.chave("custo");
+  j.valor(r.custo);
+  j.chave("tempo");
+  j.valor(r.tempo);
+  j.chave("tempo_melhor");
+  j.valor(r.tempoMelhor);
+  j.chave("seed");
+  j.valor(r.seed);
+  j.chave("run");
+  j.valor(r.run);
+  j.chave("rotas");
+  j.abrirLista();
+  for (const auto &rota : r.rotas) {
+    j.abrirLista();
+    for (int no : rota)
+      j.valor(no);
+    j.fecharLista();
+  }
+  j.fecharLista();
+  j.fecharObjeto();
+  saida = move(j.saida);
+  saida += '\n';
+}
+
+static void serializarBinario(const RegistroSolucao &r, string &saida) {
+  CabecalhoRegistroSolucao c;
+  memset(&c, 0, sizeof(c));
+  memcpy(c.magica, MAGICA_SOLUCAO, sizeof(c.magica));
+  c.versao = VERSAO_SOLUCAO_BINARIA;
+  c.hashInstancia = r.hashInstancia;
+  c.custo = r.custo;
+  c.tempo = r.tempo;
+  c.tempoMelhor = r.tempoMelhor;
+  c.seed = r.seed;
+  c.run = r.run;
+  c.numRotas = static_cast<uint32_t>(r.rotas.size());
+  for (const auto &rota : r.rotas)
+    c.totalNos += static_cast<uint32_t>(rota.size());
+  c.tamInstancia = static_cast<uint16_t>(min<size_t>(r.instancia.size(), 0xffff));
+  c.tamSolver = static_cast<uint16_t>(min<size_t>(r.solver.size(), 0xffff));
+
+  saida.assign(reinterpret_cast<const char *>(&c), sizeof(c));
+  saida.append(r.instancia, 0, c.tamInstancia);
+  saida.append(r.solver, 0, c.tamSolver);
+  for (const auto &rota : r.rotas) {
+    uint32_t tam = static_cast<uint32_t>(rota.size());
+    saida.append(reinterpret_cast<const char *>(&tam), sizeof(tam));
+  }
+  for (const auto &rota : r.rotas) {
+    for (int no : rota) {
+      int32_t v = no;
+      saida.append(reinterpret_cast<const char *>(&v), sizeof(v));
+    }
+  }
+}
+
+bool anexarSolucao(const string &arquivo, const RegistroSolucao &registro) {
+  string dados;
+  size_t tam = arquivo.size();
+  if (tam >= 6 && arquivo.compare(tam - 6, 6, ".jsonl") == 0)
+    serializarJSON(registro, dados);
+  else
+    serializarBinario(registro, dados);
+
+  int fd = open(arquivo.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0)
+    return false;
+  size_t escritos = 0;
+  while (escritos < dados.size()) {
+    ssize_t r = write(fd, dados.data() + escritos, dados.size() - escritos);
+    if (r <= 0)
+      break;
+    escritos += r;
+  }
+  bool ok = close(fd) == 0 && escritos == dados.size();
+  return ok;
+}
+
+LeitorSolucoes::LeitorSolucoes(const string &nome) {
+  arquivo = fopen(nome.c_str(), "rb");
+  if (!arquivo)
+    return;
+  int c = fgetc(arquivo);
+  binario = c == MAGICA_SOLUCAO[0];
+  if (c != EOF)
+    ungetc(c, arquivo);
+}
+
+LeitorSolucoes::~LeitorSolucoes() {
+  if (arquivo)
+    fclose(arquivo);
+}
+
+static bool lerRotasJSON(LeitorJSON &j, vector<vector<int>> &rotas) {
+  rotas.clear();
+  if (!j.esperar('['))
+    return false;
+  if (j.consumir(']'))
+    return true;
+  do {
+    rotas.emplace_back();
+    if (!j.esperar('['))
+      return false;
+    if (j.consumir(']'))
+      continue;
+    do {
+      long long no;
+      if (!j.lerInteiro(no))
+        return false;
+      rotas.back().push_back(static_cast<int>(no));
+    } while (j.consumir(','));
+    if (!j.esperar(']'))
+      return false;
+  } while (j.consumir(','));
+  return j.esperar(']');
+}
+
+static bool analisarJSON(string_view texto, RegistroSolucao &r) {
+  r = RegistroSolucao();
+  LeitorJSON j(texto);
+  if (!j.esperar('{'))
+    return false;
+  if (j.consumir('}'))
+    return true;
+  string chave, valor;
+  do {
+    if (!j.lerString(chave) || !j.esperar(':'))
+      return false;
+    if (chave == "instancia") {
+      j.lerString(r.instancia);
+    } else if (chave == "solver") {
+      j.lerString(r.solver);
+    } else if (chave == "hash") {
+      if (j.lerString(valor))
+        r.hashInstancia = strtoull(valor.c_str(), nullptr, 16);
+    } else if (chave == "custo") {
+      j.lerNumero(r.custo);
+    } else if (chave == "tempo") {
+      j.lerNumero(r.tempo);
+    } else if (chave == "tempo_melhor") {
+      j.lerNumero(r.tempoMelhor);
+    } else if (chave == "seed") {
+      j.lerInteiro(r.seed);
+    } else if (chave == "run") {
+      long long run;
+      if (j.lerInteiro(run))
+        r.run = static_cast<int>(run);
+    } else if (chave == "rotas") {
+      lerRotasJSON(j, r.rotas);
+    } else {
+      j.pularValor();
+    }
+    if (j.erro)
+      return false;
+  } while (j.consumir(','));
+  return j.esperar('}');
+}
+
+bool LeitorSolucoes::proxima(RegistroSolucao &registro) {
+  if (!arquivo || falhou)
+    return false;
+
+  if (!binario) {
+    char bloco[4096];
+    while (true) {
+      linha.clear();
+      while (fgets(bloco, sizeof(bloco), arquivo)) {
+        linha += bloco;
+        if (!linha.empty() && linha.back() == '\n')
+          break;
+      }
+      if (linha.empty())
+        return false;
+      if (linha.find_first_not_of(" \t\r\n") == string::npos)
+        continue;
+      if (!analisarJSON(linha, registro)) {
+        falhou = true;
+        return false;
+      }
+      return true;
+    }
+  }
+
+  CabecalhoRegistroSolucao c;
+  size_t lidos = fread(&c, 1, sizeof(c), arquivo);
+  if (lidos == 0)
+    return false;
+  if (lidos != sizeof(c) || memcmp(c.magica, MAGICA_SOLUCAO, 4) != 0 ||
+      c.versao != VERSAO_SOLUCAO_BINARIA || c.totalNos > (1u << 28) ||
+      c.numRotas > c.totalNos + 1) {
+    falhou = true;
+    return false;
+  }
+
+  registro = RegistroSolucao();
+  registro.hashInstancia = c.hashInstancia;
+  registro.custo = c.custo;
+  registro.tempo = c.tempo;
+  registro.tempoMelhor = c.tempoMelhor;
+  registro.seed = c.seed;
+  registro.run = c.run;
+  registro.instancia.resize(c.tamInstancia);
+  registro.solver.resize(c.tamSolver);
+  vector<uint32_t> tamanhos(c.numRotas);
+  vector<int32_t> nos(c.totalNos);
+  bool ok =
+      fread(&registro.instancia[0], 1, c.tamInstancia, arquivo) ==
+          c.tamInstancia &&
+      fread(&registro.solver[0], 1, c.tamSolver, arquivo) == c.tamSolver &&
+      fread(tamanhos.data(), sizeof(uint32_t), c.numRotas, arquivo) ==
+          c.numRotas &&
+      fread(nos.data(), sizeof(int32_t), c.totalNos, arquivo) == c.totalNos;
+
+  size_t soma = 0;
+  for (uint32_t t : tamanhos)
+    soma += t;
+  if (!ok || soma != c.totalNos) {
+    falhou = true;
+    return false;
+  }
+
+  registro.rotas.resize(c.numRotas);
+  size_t k = 0;
+  for (uint32_t r = 0; r < c.numRotas; r++) {
+    registro.rotas[r].assign(nos.begin() + k, nos.begin() + k + tamanhos[r]);
+    k += tamanhos[r];
+  }
+  return true;
+}
@@ -0,0 +1,57 @@
+#ifndef SOLUCAO_IO_HPP
+#define SOLUCAO_IO_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Solucao com os metadados da execucao, nos formatos estruturados:
+//  - .jsonl: um objeto JSON por linha,
+//      {"instancia":"E-n22-k4","hash":"...","solver":"GRASP","custo":...,
+//       "tempo":...,"tempo_melhor":...,"seed":3,"run":-1,"rotas":[[0,...,0]]}
+//  - .evrpsol: registros binarios concatenados, cada um com cabecalho fixo
+//    (magica, hash, custo, tempos, seed, run, contagens) seguido do nome da
+//    instancia, do solver, dos tamanhos das rotas e dos nos (int32).
+// Nos dois casos cada execucao e anexada com uma unica escrita (O_APPEND),
+// entao varias execucoes podem gravar no mesmo arquivo.
+struct RegistroSolucao {
+  string instancia;
+  uint64_t hashInstancia = 0;
+  string solver;
+  double custo = 0;
+  double tempo = 0;
+  double tempoMelhor = 0;
+  long long seed = -1;
+  int run = -1;
+  vector<vector<int>> rotas;
+};
+
+const unsigned int VERSAO_SOLUCAO_BINARIA = 1;
+
+// Formato pela extensao: .jsonl ou binario (qualquer outra)
+bool anexarSolucao(const string &arquivo, const RegistroSolucao &registro);
+bool arquivoSolucaoEstruturado(const string &arquivo);
+
+// Leitura em fluxo, um registro por vez, detectando o formato pelo conteudo
+struct LeitorSolucoes {
+  explicit LeitorSolucoes(const string &arquivo);
+  ~LeitorSolucoes();
+  LeitorSolucoes(const LeitorSolucoes &) = delete;
+  LeitorSolucoes &operator=(const LeitorSolucoes &) = delete;
+
+  bool aberto() const { return arquivo != nullptr; }
+  // false no fim do arquivo ou em registro corrompido (erro() distingue)
+  bool proxima(RegistroSolucao &registro);
+  bool erro() const { return falhou; }
+
+private:
+  FILE *arquivo = nullptr;
+  bool binario = false;
+  bool falhou = false;
+  string linha;
+};
+
+#endif
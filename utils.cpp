@@ -1,12 +1,26 @@
 #include "utils.hpp"
+#include "modelo_mip.hpp"
+#include "solucao_io.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
 #include <cmath>
+#include <cstdio>
+#include <fcntl.h>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
+#include <zlib.h>
 
 using namespace std;
 
@@ -30,114 +44,200 @@ void imprimirInstanciaEVRP(const InstanciaEVRP &instancia) {
   cout << "--------------------------------" << endl;
 }
 
+// Parser do formato .evrp sobre o arquivo mapeado em memoria: as linhas sao
+// tokenizadas no proprio buffer (string_view + from_chars), sem copias por
+// linha. Linhas de dados so sao interpretadas conforme a secao corrente.
+enum class SecaoEVRP { Cabecalho, Coordenadas, Demandas, Estacoes, Deposito };
+
+static bool ehEspaco(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static string_view aparar(string_view s) {
+  while (!s.empty() && ehEspaco(s.front()))
+    s.remove_prefix(1);
+  while (!s.empty() && ehEspaco(s.back()))
+    s.remove_suffix(1);
+  return s;
+}
+
+// Le o proximo numero de 'resto', pulando espacos iniciais.
+template <typename T> static bool lerNumero(string_view &resto, T &valor) {
+  while (!resto.empty() && ehEspaco(resto.front()))
+    resto.remove_prefix(1);
+  const char *inicio = resto.data();
+  const char *fim = inicio + resto.size();
+  if (inicio != fim && *inicio == '+')
+    inicio++;
+  auto [ptr, ec] = from_chars(inicio, fim, valor);
+  if (ec != errc() || (ptr != fim && !ehEspaco(*ptr)))
+    return false;
+  resto.remove_prefix(ptr - resto.data());
+  return true;
+}
+
 bool carregarInstancia(const string &nomeArquivo, InstanciaEVRP &instancia) {
   string caminhoCompleto = "dataset/" + nomeArquivo + ".evrp";
-  ifstream arquivo(caminhoCompleto);
+  int fd = open(caminhoCompleto.c_str(), O_RDONLY);
 
-  if (!arquivo.is_open()) {
+  if (fd < 0) {
     cerr << "Erro: Nao foi possivel abrir o arquivo " << caminhoCompleto
          << endl;
     return false;
   }
 
-  string linha;
-  string secaoAtual = "";
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    cerr << "Erro: Arquivo vazio ou ilegivel " << caminhoCompleto << endl;
+    close(fd);
+    return false;
+  }
 
-  while (getline(arquivo, linha)) {
+  size_t tamanho = info.st_size;
+  void *mapa = mmap(nullptr, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapa == MAP_FAILED) {
+    cerr << "Erro: Falha ao mapear o arquivo " << caminhoCompleto << endl;
+    return false;
+  }
+  madvise(mapa, tamanho, MADV_SEQUENTIAL);
 
-    if (linha.find_first_not_of(" \t") == string::npos) {
-      continue;
-    }
+  string_view conteudo(static_cast<const char *>(mapa), tamanho);
+  SecaoEVRP secaoAtual = SecaoEVRP::Cabecalho;
+  int numeroLinha = 0;
+  bool ok = true;
 
-    if (linha.find("NODE_COORD_SECTION") != string::npos) {
-      secaoAtual = "NODE_COORD_SECTION";
-      continue;
-    } else if (linha.find("DEMAND_SECTION") != string::npos) {
-      secaoAtual = "DEMAND_SECTION";
-      continue;
-    } else if (linha.find("STATIONS_COORD_SECTION") != string::npos) {
-      secaoAtual = "STATIONS_COORD_SECTION";
-      continue;
-    } else if (linha.find("DEPOT_SECTION") != string::npos) {
-      secaoAtual = "DEPOT_SECTION";
-      continue;
-    } else if (linha.find("EOF") != string::npos) {
-      break;
-    }
+  while (!conteudo.empty() && ok) {
+    size_t quebra = conteudo.find('\n');
+    string_view linhaBruta = conteudo.substr(0, quebra);
+    conteudo.remove_prefix(quebra == string_view::npos ? conteudo.size()
+                                                       : quebra + 1);
+    numeroLinha++;
 
-    istringstream issLinha(linha);
+    string_view linha = aparar(linhaBruta);
+    if (linha.empty())
+      continue;
 
-    if (secaoAtual == "") {
-      size_t divisorPos = linha.find(":");
-      if (divisorPos == string::npos)
+    // Palavras-chave e cabecalho comecam com letra; dados com digito ou '-'
+    if (isalpha(static_cast<unsigned char>(linha.front()))) {
+      if (linha.rfind("NODE_COORD_SECTION", 0) == 0) {
+        secaoAtual = SecaoEVRP::Coordenadas;
+        instancia.nos.reserve(instancia.dimensao + instancia.estacoes);
         continue;
+      } else if (linha.rfind("DEMAND_SECTION", 0) == 0) {
+        secaoAtual = SecaoEVRP::Demandas;
+        instancia.demandas.reserve(instancia.dimensao);
+        continue;
+      } else if (linha.rfind("STATIONS_COORD_SECTION", 0) == 0) {
+        secaoAtual = SecaoEVRP::Estacoes;
+        instancia.idEstacoes.reserve(instancia.estacoes);
+        continue;
+      } else if (linha.rfind("DEPOT_SECTION", 0) == 0) {
+        secaoAtual = SecaoEVRP::Deposito;
+        continue;
+      } else if (linha.rfind("EOF", 0) == 0) {
+        break;
+      }
 
-      string chave = linha.substr(0, divisorPos);
-      size_t ultimoCaractereChave = chave.find_last_not_of(" \t");
-      if (ultimoCaractereChave != string::npos) {
-        chave = chave.substr(0, ultimoCaractereChave + 1);
+      if (secaoAtual != SecaoEVRP::Cabecalho) {
+        cerr << "Erro: " << caminhoCompleto << ":" << numeroLinha
+             << ": linha inesperada na secao de dados" << endl;
+        ok = false;
+        break;
       }
 
-      string valorStr = linha.substr(divisorPos + 1);
-      size_t primeiroCaractereValor = valorStr.find_first_not_of(" \t");
-      if (primeiroCaractereValor == string::npos)
+      size_t divisorPos = linhaBruta.find(':');
+      if (divisorPos == string_view::npos)
         continue;
-      valorStr = valorStr.substr(primeiroCaractereValor);
 
-      stringstream ssValor(valorStr);
+      string_view chave = aparar(linhaBruta.substr(0, divisorPos));
+      // O valor mantem espacos finais, como no formato original
+      string_view valorStr = linhaBruta.substr(divisorPos + 1);
+      while (!valorStr.empty() && ehEspaco(valorStr.front()))
+        valorStr.remove_prefix(1);
+      if (!valorStr.empty() && valorStr.back() == '\r')
+        valorStr.remove_suffix(1);
+      if (valorStr.empty())
+        continue;
 
+      string_view numero = valorStr;
+      bool numeroOk = true;
       if (chave == "Name") {
-        instancia.nome = valorStr;
+        instancia.nome = string(valorStr);
       } else if (chave == "COMMENT") {
-        instancia.comentario = valorStr;
+        instancia.comentario = string(valorStr);
       } else if (chave == "TYPE") {
-        instancia.tipo = valorStr;
+        instancia.tipo = string(valorStr);
       } else if (chave == "OPTIMAL_VALUE") {
-        ssValor >> instancia.valorOtimo;
+        numeroOk = lerNumero(numero, instancia.valorOtimo);
       } else if (chave == "VEHICLES") {
-        ssValor >> instancia.veiculos;
+        numeroOk = lerNumero(numero, instancia.veiculos);
       } else if (chave == "DIMENSION") {
-        ssValor >> instancia.dimensao;
+        numeroOk = lerNumero(numero, instancia.dimensao);
       } else if (chave == "STATIONS") {
-        ssValor >> instancia.estacoes;
+        numeroOk = lerNumero(numero, instancia.estacoes);
         instancia.estacoesTotal = instancia.estacoes * instancia.veiculos;
       } else if (chave == "CAPACITY") {
-        ssValor >> instancia.capacidade;
+        numeroOk = lerNumero(numero, instancia.capacidade);
       } else if (chave == "ENERGY_CAPACITY") {
-        ssValor >> instancia.capacidadeEnergia;
+        numeroOk = lerNumero(numero, instancia.capacidadeEnergia);
       } else if (chave == "ENERGY_CONSUMPTION") {
-        ssValor >> instancia.consumoEnergia;
+        numeroOk = lerNumero(numero, instancia.consumoEnergia);
       } else if (chave == "EDGE_WEIGHT_FORMAT") {
-        instancia.formatoBorda = valorStr;
-      }
-    } else if (secaoAtual == "NODE_COORD_SECTION") {
-      int id;
-      double x, y;
-      if (issLinha >> id >> x >> y) {
-        instancia.nos.push_back({id, x, y});
+        instancia.formatoBorda = string(valorStr);
       }
-    } else if (secaoAtual == "DEMAND_SECTION") {
-      int id, demanda;
-      if (issLinha >> id >> demanda) {
-        instancia.demandas.push_back({id, demanda});
+
+      if (!numeroOk) {
+        cerr << "Erro: " << caminhoCompleto << ":" << numeroLinha
+             << ": valor numerico invalido para " << chave << endl;
+        ok = false;
       }
-    } else if (secaoAtual == "STATIONS_COORD_SECTION") {
+      continue;
+    }
+
+    string_view resto = linha;
+    switch (secaoAtual) {
+    case SecaoEVRP::Coordenadas: {
+      No no;
+      ok = lerNumero(resto, no.id) && lerNumero(resto, no.x) &&
+           lerNumero(resto, no.y);
+      if (ok)
+        instancia.nos.push_back(no);
+      break;
+    }
+    case SecaoEVRP::Demandas: {
+      DemandaNo d;
+      ok = lerNumero(resto, d.id) && lerNumero(resto, d.demanda);
+      if (ok)
+        instancia.demandas.push_back(d);
+      break;
+    }
+    case SecaoEVRP::Estacoes: {
       int id;
-      if (issLinha >> id) {
+      ok = lerNumero(resto, id);
+      if (ok)
         instancia.idEstacoes.push_back(id);
-      }
-    } else if (secaoAtual == "DEPOT_SECTION") {
+      break;
+    }
+    case SecaoEVRP::Deposito: {
       int id;
-      if (issLinha >> id) {
-        if (id != -1) {
-          instancia.idDeposito = id;
-        }
-      }
+      ok = lerNumero(resto, id);
+      if (ok && id != -1)
+        instancia.idDeposito = id;
+      break;
+    }
+    case SecaoEVRP::Cabecalho:
+      break;
+    }
+
+    if (!ok) {
+      cerr << "Erro: " << caminhoCompleto << ":" << numeroLinha
+           << ": nao foi possivel interpretar '" << linha << "'" << endl;
     }
   }
 
-  arquivo.close();
-  return true;
+  munmap(mapa, tamanho);
+  return ok;
 }
 
 double calcularDistancia(const No &a, const No &b) {
@@ -146,6 +246,93 @@ double calcularDistancia(const No &a, const No &b) {
   return sqrt(dx * dx + dy * dy);
 }
 
+void construirMatrizDistancia(const InstanciaEVRP &instancia,
+                              MatrizDistancia &dist) {
+  int n = instancia.dimensao;
+  int m = instancia.estacoesTotal;
+  int totalNos = n + m;
+
+  dist.tamanho = totalNos;
+  dist.propria.assign(static_cast<size_t>(totalNos) * totalNos, 0.0);
+  dist.mapeamento.reset();
+  double *d = dist.propria.data();
+  dist.dados = d;
+
+  // Posicao em nos de cada indice: clientes diretos, copias de estacoes
+  // apontam para a estacao fisica s % estacoes
+  vector<int> posicao(totalNos);
+  for (int i = 0; i < n; i++) {
+    posicao[i] = i;
+  }
+  for (int s = 0; s < m; s++) {
+    posicao[n + s] = instancia.idEstacoes[s % instancia.estacoes] - 1;
+  }
+
+  for (int i = 0; i < totalNos; i++) {
+    const No &a = instancia.nos[posicao[i]];
+    for (int j = 0; j < totalNos; j++) {
+      d[static_cast<size_t>(i) * totalNos + j] =
+          calcularDistancia(a, instancia.nos[posicao[j]]);
+    }
+  }
+}
+
+// Posicao, demanda e recarga por indice de no (sem vizinhos)
+static void preencherTabelasBasicas(const InstanciaEVRP &instancia,
+                                    TabelasInstancia &t) {
+  int n = instancia.dimensao;
+  int m = instancia.estacoesTotal;
+  int totalNos = n + m;
+
+  t.posicaoNo.assign(totalNos, 0);
+  t.demanda.assign(totalNos, 0);
+  t.recarga.assign(totalNos, 0);
+  for (int i = 0; i < n; i++) {
+    t.posicaoNo[i] = i;
+    t.recarga[i] = isEstacao(instancia, i);
+  }
+  for (int s = 0; s < m; s++) {
+    t.posicaoNo[n + s] = instancia.idEstacoes[s % instancia.estacoes] - 1;
+    t.recarga[n + s] = 1;
+  }
+  for (const auto &d : instancia.demandas) {
+    if (d.id >= 1 && d.id <= n) {
+      t.demanda[d.id - 1] = d.demanda;
+    }
+  }
+}
+
+void prepararInstancia(InstanciaEVRP &instancia, bool comMatriz) {
+  int n = instancia.dimensao;
+  TabelasInstancia &t = instancia.tabelas;
+  preencherTabelasBasicas(instancia, t);
+
+  // Vizinhos mais proximos de cada cliente (entre clientes)
+  t.numVizinhos = max(0, min(16, n - 2));
+  t.vizinhos.assign(static_cast<size_t>(n) * t.numVizinhos, 0);
+  vector<pair<double, int>> candidatos;
+  for (int c = 1; c < n && t.numVizinhos > 0; c++) {
+    candidatos.clear();
+    for (int v = 1; v < n; v++) {
+      if (v != c)
+        candidatos.push_back(
+            {calcularDistancia(instancia.nos[c], instancia.nos[v]), v});
+    }
+    partial_sort(candidatos.begin(), candidatos.begin() + t.numVizinhos,
+                 candidatos.end());
+    for (int k = 0; k < t.numVizinhos; k++) {
+      t.vizinhos[static_cast<size_t>(c) * t.numVizinhos + k] =
+          candidatos[k].second;
+    }
+  }
+
+  if (comMatriz) {
+    auto matriz = make_shared<MatrizDistancia>();
+    construirMatrizDistancia(instancia, *matriz);
+    instancia.distancias = matriz;
+  }
+}
+
 No getNoByIndex(const InstanciaEVRP &instancia, int idx) {
   int n = instancia.dimensao;
   int estacoes = instancia.estacoes;
@@ -179,189 +366,146 @@ int getDemandaByNodeId(const InstanciaEVRP &instancia, int nodeId) {
   return 0;
 }
 
-void exportEVRPtoLP(const InstanciaEVRP &instancia, const string &nomeArquivo) {
-  string lpFilename = nomeArquivo + ".lp";
-  ofstream lpFile(lpFilename);
-
-  if (!lpFile.is_open()) {
-    cerr << "Erro ao criar arquivo .lp" << endl;
+void executarParalelo(int total, int numThreads,
+                      const function<void(int)> &tarefa) {
+  if (numThreads <= 0)
+    numThreads = max(1u, thread::hardware_concurrency());
+  numThreads = min(numThreads, total);
+  if (numThreads <= 1) {
+    for (int k = 0; k < total; k++)
+      tarefa(k);
     return;
   }
 
-  cout << "Gerando arquivo LP: " << lpFilename << "..." << endl;
-
-  int n = instancia.dimensao;
-  int m = instancia.estacoesTotal;
-  int numClientes = n - 1;
-  int totalNos = n + m;
-
-  double h = instancia.consumoEnergia;
-  double Q = instancia.capacidadeEnergia;
-  double C = instancia.capacidade;
-
-  vector<vector<double>> dist(totalNos, vector<double>(totalNos, 0.0));
-  for (int i = 0; i < totalNos; i++) {
-    for (int j = 0; j < totalNos; j++) {
-      No noI = getNoByIndex(instancia, i);
-      No noJ = getNoByIndex(instancia, j);
-      dist[i][j] = calcularDistancia(noI, noJ);
-    }
+  atomic<int> proxima(0);
+  vector<thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.emplace_back([&]() {
+      for (int k = proxima++; k < total; k = proxima++)
+        tarefa(k);
+    });
   }
+  for (auto &th : threads)
+    th.join();
+}
 
-  lpFile << fixed << setprecision(6);
-
-  lpFile << "Minimize" << endl;
-  lpFile << " obj: ";
-
-  bool first = true;
-  for (int i = 0; i < totalNos; i++) {
-    for (int j = 0; j < totalNos; j++) {
-      if (i != j) {
-        if (!first)
-          lpFile << " + ";
-        lpFile << dist[i][j] << " x_" << i << "_" << j;
-        first = false;
-      }
-    }
-  }
-  lpFile << endl;
-
-  lpFile << "Subject To" << endl;
-
-  for (int i = 1; i <= numClientes; i++) {
-    first = true;
-    lpFile << " c2_" << i << ": ";
-    for (int j = 0; j < totalNos; j++) {
-      if (i != j) {
-        if (!first)
-          lpFile << " + ";
-        lpFile << "x_" << i << "_" << j;
-        first = false;
-      }
-    }
-    lpFile << " = 1" << endl;
-  }
-
-  lpFile << endl;
-
-  for (int s = 0; s < m; s++) {
-    int idx = n + s;
-    first = true;
-    lpFile << " c3_" << s + 1 << ": ";
-    for (int j = 0; j < totalNos; j++) {
-      if (idx != j) {
-        if (!first)
-          lpFile << " + ";
-        lpFile << "x_" << idx << "_" << j;
-        first = false;
-      }
-    }
-    lpFile << " <= 1" << endl;
-  }
-
-  lpFile << endl;
-
-  for (int j = 1; j < totalNos; j++) {
-    bool first = true;
-    lpFile << " c4_" << j << ": ";
-    for (int i = 0; i < totalNos; i++) {
-      if (i != j) {
-        if (!first)
-          lpFile << " +";
-        lpFile << " x_" << j << "_" << i;
-        first = false;
-      }
-    }
-
-    for (int i = 0; i < totalNos; i++) {
-      if (i != j) {
-        lpFile << " - x_" << i << "_" << j;
-      }
-    }
-
-    lpFile << " = 0" << endl;
+// FNV-1a sobre o conteudo que define o modelo: escalares, coordenadas,
+// demandas e estacoes (nome e comentario nao entram).
+static void misturarHash(uint64_t &h, const void *dados, size_t bytes) {
+  const unsigned char *p = static_cast<const unsigned char *>(dados);
+  for (size_t k = 0; k < bytes; k++) {
+    h ^= p[k];
+    h *= 1099511628211ULL;
   }
+}
 
-  lpFile << endl;
-
-  for (int i = 1; i <= numClientes; i++) {
-    for (int j = 0; j < totalNos; j++) {
-      if (i != j) {
-        double coef = h * dist[i][j] + Q;
+string nomeBaseInstancia(const string &nomeArquivo) {
+  string nome = nomeArquivo;
+  size_t barra = nome.rfind('/');
+  if (barra != string::npos)
+    nome = nome.substr(barra + 1);
+  size_t ext = nome.find(".evrp");
+  if (ext != string::npos)
+    nome = nome.substr(0, ext);
+  return nome;
+}
 
-        lpFile << " c5_" << i << "_" << j << "a: y_" << j << " >= 0" << endl;
-        lpFile << " c5_" << i << "_" << j << "b: y_" << j << " - y_" << i
-               << " + " << coef << " x_" << i << "_" << j << " <= " << Q
-               << endl;
-      }
-    }
+uint64_t hashInstancia(const InstanciaEVRP &instancia) {
+  uint64_t h = 1469598103934665603ULL;
+  int inteiros[] = {instancia.veiculos,   instancia.dimensao,
+                    instancia.estacoes,   instancia.estacoesTotal,
+                    instancia.capacidade, instancia.capacidadeEnergia,
+                    instancia.idDeposito};
+  misturarHash(h, inteiros, sizeof(inteiros));
+  misturarHash(h, &instancia.consumoEnergia, sizeof(double));
+  for (const auto &no : instancia.nos) {
+    misturarHash(h, &no.id, sizeof(no.id));
+    misturarHash(h, &no.x, sizeof(no.x));
+    misturarHash(h, &no.y, sizeof(no.y));
   }
-
-  lpFile << endl;
-
-  vector<int> rechargingSources;
-  rechargingSources.push_back(0); 
-  for (int k = totalNos - m; k < totalNos; k++) {
-    rechargingSources.push_back(k); 
+  for (const auto &d : instancia.demandas) {
+    misturarHash(h, &d.id, sizeof(d.id));
+    misturarHash(h, &d.demanda, sizeof(d.demanda));
   }
-
-  for (int j = 1; j < totalNos; j++) {
-    lpFile << " c6_" << j << "_a: y_" << j << " >= 0" << endl;
-
-    for (int i : rechargingSources) {
-      if (i != j) {
-        double custo = h * dist[i][j];
-
-        lpFile << " c6_" << j << "_" << i << "_b: y_" << j << " + " << custo
-               << " x_" << i << "_" << j << " <= " << Q << endl;
-      }
-    }
+  for (int id : instancia.idEstacoes) {
+    misturarHash(h, &id, sizeof(id));
   }
+  return h;
+}
 
-  lpFile << endl;
-
-  for (int j = 1; j < totalNos; j++) {
-    lpFile << " c7_" << j << "_a: u_" << j << " >= 0" << endl;
-
-    for (int i = 0; i < totalNos; i++) {
-      if (i != j) {
-
-        No noJ = getNoByIndex(instancia, j);
-        double q_dest = getDemandaByNodeId(instancia, noJ.id);
+// Primeira linha do arquivo de modelo (sem o marcador de comentario do
+// formato): identifica instancia e formulacao
+static string cabecalhoLP(const InstanciaEVRP &instancia,
+                          const OpcoesLP &opcoes) {
+  char tmp[128];
+  snprintf(tmp, sizeof(tmp),
+           "evrp-lp hash=%016llx formulacao=%d eliminacao=%d cortes=%d\n",
+           static_cast<unsigned long long>(hashInstancia(instancia)),
+           VERSAO_FORMULACAO_LP, opcoes.eliminarArcos ? 1 : 0,
+           opcoes.cortes ? 1 : 0);
+  return tmp;
+}
 
-        double x_coefficient = C + q_dest;
+bool formatoModeloValido(const string &formato) {
+  return formato == "lp" || formato == "lp.gz" || formato == "mps" ||
+         formato == "mps.gz";
+}
 
-        lpFile << " c7_" << j << "_" << i << "_b: ";
-        lpFile << "u_" << j << " - u_" << i << " + " << x_coefficient << " x_"
-               << i << "_" << j << " <= " << C << endl;
+string exportEVRPtoLP(const InstanciaEVRP &instancia, const string &nomeArquivo,
+                      const OpcoesLP &opcoes) {
+  string lpFilename = nomeArquivo + "." + opcoes.formato;
+  bool mps = opcoes.formato.compare(0, 3, "mps") == 0;
+  string primeiraLinha = (mps ? "* " : "\\ ") + cabecalhoLP(instancia, opcoes);
+
+  // gzgets tambem le arquivos sem compressao
+  if (!opcoes.forcar) {
+    gzFile existente = gzopen(lpFilename.c_str(), "rb");
+    if (existente) {
+      char linha[256];
+      bool atualizado = gzgets(existente, linha, sizeof(linha)) &&
+                        primeiraLinha == linha;
+      gzclose(existente);
+      if (atualizado) {
+        cout << "Arquivo LP atualizado encontrado: " << lpFilename << endl;
+        return lpFilename;
       }
     }
   }
 
-  lpFile << endl;
-
-  lpFile << " c8a: u_0 >= 0" << endl;
-  lpFile << " c8b: u_0 <= " << C << endl;
-
-  lpFile << "Bounds" << endl;
+  cout << "Gerando arquivo LP: " << lpFilename << "..." << endl;
 
-  for (int i = 0; i < totalNos; i++) {
-    lpFile << " 0 <= y_" << i << " <= " << Q << endl;
-    lpFile << " 0 <= u_" << i << " <= " << C << endl;
+  ModeloMIP modelo;
+  EstatisticasModelo stats;
+  construirModeloEVRP(instancia, opcoes, modelo, &stats);
+  // O nome da instancia pode ter espacos, invalidos na linha NAME do MPS
+  modelo.nome = nomeArquivo.substr(nomeArquivo.rfind('/') + 1);
+
+  // Grava em arquivo temporario: um LP interrompido nunca fica com um
+  // cabecalho valido
+  string temporario = lpFilename + ".tmp";
+  if (!gravarModelo(modelo, temporario, opcoes.formato, primeiraLinha) ||
+      rename(temporario.c_str(), lpFilename.c_str()) != 0) {
+    cerr << "Erro ao gravar arquivo " << lpFilename << endl;
+    remove(temporario.c_str());
+    return "";
   }
-
-  lpFile << "Binary" << endl;
-  for (int i = 0; i < totalNos; i++) {
-    for (int j = 0; j < totalNos; j++) {
-      if (i != j) {
-        lpFile << " x_" << i << "_" << j << endl;
-      }
-    }
-  }
-
-  lpFile << "End" << endl;
-  lpFile.close();
   cout << "Arquivo LP gerado com sucesso." << endl;
+  cout << "Modelo: " << modelo.numColunas() << " variaveis, "
+       << modelo.numLinhas() << " restricoes, " << modelo.numNaoNulos()
+       << " nao nulos (" << modelo.linhasDobradas
+       << " restricoes de um termo convertidas em limites)" << endl;
+  if (opcoes.cortes) {
+    cout << "Cortes estaticos: " << stats.cortesAdicionados
+         << " restricoes adicionadas" << endl;
+  }
+  if (opcoes.eliminarArcos) {
+    int totalNos = instancia.dimensao + instancia.estacoesTotal;
+    long long arcosTotal = static_cast<long long>(totalNos) * (totalNos - 1);
+    cout << "Eliminacao de arcos: " << stats.arcosRemovidos << " de "
+         << arcosTotal << " variaveis x e " << stats.restricoesRemovidas
+         << " restricoes removidas" << endl;
+  }
+  return lpFilename;
 }
 
 bool isEstacao(const InstanciaEVRP &instancia, int idx) {
@@ -385,8 +529,45 @@ bool isEstacao(const InstanciaEVRP &instancia, int idx) {
   return false;
 }
 
-bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
-                 const vector<vector<double>> &dist, bool verbose) {
+// Consultas O(1) usadas na validacao: tabelas da instancia (ou montadas na
+// hora, O(n + m), se ainda nao existirem) e distancia pela matriz, quando
+// houver, ou calculada das coordenadas so para os arcos percorridos.
+struct ConsultaValidacao {
+  const InstanciaEVRP &instancia;
+  const MatrizDistancia *matriz;
+  int totalNos;
+  const int *posicaoNo;
+  const int *demanda;
+  const char *recarga;
+  TabelasInstancia locais;
+
+  ConsultaValidacao(const InstanciaEVRP &inst, const MatrizDistancia *dist)
+      : instancia(inst), matriz(dist),
+        totalNos(inst.dimensao + inst.estacoesTotal) {
+    const TabelasInstancia *t = &inst.tabelas;
+    if ((int)t->posicaoNo.size() != totalNos) {
+      preencherTabelasBasicas(inst, locais);
+      t = &locais;
+    }
+    posicaoNo = t->posicaoNo.data();
+    demanda = t->demanda.data();
+    recarga = t->recarga.data();
+  }
+
+  bool indiceValido(int no) const { return no >= 0 && no < totalNos; }
+
+  double distancia(int a, int b) const {
+    if (matriz)
+      return (*matriz)[a][b];
+    return calcularDistancia(instancia.nos[posicaoNo[a]],
+                             instancia.nos[posicaoNo[b]]);
+  }
+};
+
+static bool validarRota(const ConsultaValidacao &consulta,
+                        const vector<int> &rota, bool verbose,
+                        double *distanciaRota) {
+  const InstanciaEVRP &instancia = consulta.instancia;
   if (rota.size() < 2) {
     if (verbose) {
       cerr << "Erro: Rota muito curta (menos de 2 nos)" << endl;
@@ -402,6 +583,15 @@ bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
     return false;
   }
 
+  for (int no : rota) {
+    if (!consulta.indiceValido(no)) {
+      if (verbose) {
+        cerr << "Erro: Indice de no invalido: " << no << endl;
+      }
+      return false;
+    }
+  }
+
   double energia = instancia.capacidadeEnergia;
   double capacidade = instancia.capacidade;
   double distanciaTotal = 0.0;
@@ -413,9 +603,10 @@ bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
     int de = rota[i];
     int para = rota[i + 1];
 
-    double consumoEnergia = h * dist[de][para];
+    double d = consulta.distancia(de, para);
+    double consumoEnergia = h * d;
     energia -= consumoEnergia;
-    distanciaTotal += dist[de][para];
+    distanciaTotal += d;
 
     if (energia < -0.0001) {
       if (verbose) {
@@ -423,13 +614,12 @@ bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
              << endl;
         cerr << "  Energia restante: " << energia << endl;
         cerr << "  Consumo do trecho: " << consumoEnergia << endl;
-        cerr << "  Distancia do trecho: " << dist[de][para] << endl;
+        cerr << "  Distancia do trecho: " << d << endl;
       }
       valido = false;
     }
 
-    No noDestino = getNoByIndex(instancia, para);
-    int demanda = getDemandaByNodeId(instancia, noDestino.id);
+    int demanda = consulta.demanda[para];
     capacidade -= demanda;
 
     if (capacidade < -0.0001) {
@@ -441,7 +631,7 @@ bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
       valido = false;
     }
 
-    if (isEstacao(instancia, para)) {
+    if (consulta.recarga[para]) {
       energia = instancia.capacidadeEnergia;
     }
 
@@ -453,13 +643,17 @@ bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
   if (verbose && valido) {
     cout << "  Rota valida! Distancia: " << distanciaTotal << endl;
   }
+  if (distanciaRota) {
+    *distanciaRota = distanciaTotal;
+  }
 
   return valido;
 }
 
-bool validarSolucao(const InstanciaEVRP &instancia,
-                    const vector<vector<int>> &rotas,
-                    const vector<vector<double>> &dist, bool verbose) {
+static bool validarSolucao(const ConsultaValidacao &consulta,
+                           const vector<vector<int>> &rotas, bool verbose,
+                           double *custo) {
+  const InstanciaEVRP &instancia = consulta.instancia;
   if (rotas.empty()) {
     if (verbose) {
       cerr << "Erro: Solucao sem rotas" << endl;
@@ -494,13 +688,11 @@ bool validarSolucao(const InstanciaEVRP &instancia,
       cout << endl;
     }
 
-    if (!validarRota(instancia, rotas[r], dist, verbose)) {
+    double distanciaRota = 0.0;
+    if (!validarRota(consulta, rotas[r], verbose, &distanciaRota)) {
       todasValidas = false;
     }
-
-    for (size_t i = 0; i < rotas[r].size() - 1; i++) {
-      distanciaTotal += dist[rotas[r][i]][rotas[r][i + 1]];
-    }
+    distanciaTotal += distanciaRota;
 
     for (int no : rotas[r]) {
       if (no >= 1 && no <= numClientes) {
@@ -529,11 +721,47 @@ bool validarSolucao(const InstanciaEVRP &instancia,
     cout << "Distancia total: " << distanciaTotal << endl;
     cout << "Status: " << (todasValidas ? "VALIDO" : "INVALIDO") << endl;
   }
+  if (custo) {
+    *custo = distanciaTotal;
+  }
 
   return todasValidas;
 }
 
+bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
+                 const MatrizDistancia &dist, bool verbose) {
+  ConsultaValidacao consulta(instancia, &dist);
+  return validarRota(consulta, rota, verbose, nullptr);
+}
+
+bool validarSolucao(const InstanciaEVRP &instancia,
+                    const vector<vector<int>> &rotas,
+                    const MatrizDistancia &dist, bool verbose) {
+  ConsultaValidacao consulta(instancia, &dist);
+  return validarSolucao(consulta, rotas, verbose, nullptr);
+}
+
+bool validarSolucao(const InstanciaEVRP &instancia,
+                    const vector<vector<int>> &rotas, bool verbose,
+                    double *custo) {
+  ConsultaValidacao consulta(instancia, instancia.distancias.get());
+  return validarSolucao(consulta, rotas, verbose, custo);
+}
+
 bool carregarSolucao(const string &nomeArquivo, vector<vector<int>> &rotas) {
+  // Formatos estruturados: usa o primeiro registro do arquivo
+  if (arquivoSolucaoEstruturado(nomeArquivo)) {
+    LeitorSolucoes leitor(nomeArquivo);
+    RegistroSolucao registro;
+    if (!leitor.aberto() || !leitor.proxima(registro)) {
+      cerr << "Erro: Nao foi possivel ler a solucao do arquivo " << nomeArquivo
+           << endl;
+      return false;
+    }
+    rotas = move(registro.rotas);
+    return true;
+  }
+
   ifstream arquivo(nomeArquivo);
 
   if (!arquivo.is_open()) {
@@ -612,18 +840,5 @@ bool verificarSolucaoArquivo(const InstanciaEVRP &instancia,
   }
   cout << endl;
 
-  int n = instancia.dimensao;
-  int m = instancia.estacoesTotal;
-  int totalNos = n + m;
-
-  vector<vector<double>> dist(totalNos, vector<double>(totalNos, 0.0));
-  for (int i = 0; i < totalNos; i++) {
-    for (int j = 0; j < totalNos; j++) {
-      No noI = getNoByIndex(instancia, i);
-      No noJ = getNoByIndex(instancia, j);
-      dist[i][j] = calcularDistancia(noI, noJ);
-    }
-  }
-
-  return validarSolucao(instancia, rotas, dist, true);
+  return validarSolucao(instancia, rotas, true);
 }
\ No newline at end of file
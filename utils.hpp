@@ -1,6 +1,9 @@
 #ifndef UTILS_HPP
 #define UTILS_HPP
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,6 +20,34 @@ struct DemandaNo {
   int demanda;
 };
 
+// Matriz densa de distancias entre indices de nos (clientes seguidos das
+// copias de estacoes), em um unico bloco contiguo: dist[i][j]. Os dados
+// pertencem a propria matriz ou a um cache binario mapeado em memoria, caso
+// em que processos concorrentes compartilham as mesmas paginas fisicas.
+struct MatrizDistancia {
+  int tamanho = 0;
+  const double *dados = nullptr;
+  vector<double> propria;
+  shared_ptr<const void> mapeamento;
+
+  MatrizDistancia() = default;
+  MatrizDistancia(const MatrizDistancia &) = delete;
+  MatrizDistancia &operator=(const MatrizDistancia &) = delete;
+
+  const double *operator[](int i) const {
+    return dados + static_cast<size_t>(i) * tamanho;
+  }
+};
+
+// Tabelas derivadas indexadas pelo indice do no (0..dimensao+estacoesTotal-1)
+struct TabelasInstancia {
+  vector<int> posicaoNo;  // posicao em InstanciaEVRP::nos
+  vector<int> demanda;    // demanda do no (0 para deposito e estacoes)
+  vector<char> recarga;   // deposito ou copia de estacao
+  int numVizinhos = 0;
+  vector<int> vizinhos;   // clientes mais proximos de cada cliente, por linha
+};
+
 struct InstanciaEVRP {
   string nome;
   string comentario;
@@ -35,6 +66,10 @@ struct InstanciaEVRP {
   vector<No> nos;
   vector<DemandaNo> demandas;
   vector<int> idEstacoes;
+
+  // Preenchidos por prepararInstancia ou pelo cache binario
+  TabelasInstancia tabelas;
+  shared_ptr<const MatrizDistancia> distancias;
 };
 
 void imprimirNo(const No &n);
@@ -43,14 +78,43 @@ void imprimirInstanciaEVRP(const InstanciaEVRP &instancia);
 bool carregarInstancia(const string &nomeArquivo, InstanciaEVRP &instancia);
 double calcularDistancia(const No &a, const No &b);
 No getNoByIndex(const InstanciaEVRP &instancia, int idx);
-void exportEVRPtoLP(const InstanciaEVRP &instancia, const string &nomeArquivo);
+// Versao da formulacao gravada no cabecalho do LP; altere ao mudar o modelo
+const int VERSAO_FORMULACAO_LP = 2;
+
+struct OpcoesLP {
+  bool forcar = false;        // regenera o LP mesmo com cabecalho compativel
+  bool eliminarArcos = true;  // remove arcos comprovadamente inviaveis
+  bool cortes = false;        // frota, simetria de estacoes e limites de y/u
+  string formato = "lp";      // lp, lp.gz, mps (MPS livre) ou mps.gz
+  string inicioMIP;           // .mst (CPLEX) ou .sol (Gurobi) lido pelo solver
+};
+
+uint64_t hashInstancia(const InstanciaEVRP &instancia);
+// "dataset/E-n22-k4.evrp" -> "E-n22-k4"
+string nomeBaseInstancia(const string &nomeArquivo);
+bool formatoModeloValido(const string &formato);
+// Exporta o modelo para <nomeArquivo>.<formato>; retorna o caminho gravado
+// (ou reaproveitado), vazio em caso de erro
+string exportEVRPtoLP(const InstanciaEVRP &instancia, const string &nomeArquivo,
+                      const OpcoesLP &opcoes = OpcoesLP());
+// Executa tarefa(0..total-1) em numThreads threads (<= 0: todos os nucleos)
+void executarParalelo(int total, int numThreads,
+                      const function<void(int)> &tarefa);
 int getDemandaByNodeId(const InstanciaEVRP &instancia, int nodeId);
 
+void construirMatrizDistancia(const InstanciaEVRP &instancia,
+                              MatrizDistancia &dist);
+void prepararInstancia(InstanciaEVRP &instancia, bool comMatriz = true);
+
 bool isEstacao(const InstanciaEVRP &instancia, int idx);
 bool validarRota(const InstanciaEVRP &instancia, const vector<int> &rota,
-                 const vector<vector<double>> &dist, bool verbose = true);
+                 const MatrizDistancia &dist, bool verbose = true);
+bool validarSolucao(const InstanciaEVRP &instancia, const vector<vector<int>> &rotas,
+                    const MatrizDistancia &dist, bool verbose = true);
+// Pela matriz da instancia quando houver; sem ela, distancias calculadas
+// das coordenadas so nos arcos das rotas
 bool validarSolucao(const InstanciaEVRP &instancia, const vector<vector<int>> &rotas,
-                    const vector<vector<double>> &dist, bool verbose = true);
+                    bool verbose = true, double *custo = nullptr);
 
 bool carregarSolucao(const string &nomeArquivo, vector<vector<int>> &rotas);
 bool verificarSolucaoArquivo(const InstanciaEVRP &instancia, const string &nomeInstancia,
@@ -1,42 +1,224 @@
+#include "contexto_solver.hpp"
+#include "modelo_mip.hpp"
+#include "solucao_io.hpp"
 #include "utils.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 using namespace std;
 
+static void imprimirUso() {
+  cerr << "Usage: ./verify <instance_name> [--cplex|--gurobi]" << endl;
+  cerr << "       ./verify --all [--dir=solucoes] [--threads=N]" << endl;
+  cerr << "       ./verify <instance_name> --inicio-mip=<file.mst|file.sol>"
+          " [--cortes] [--sem-eliminacao-arcos]"
+       << endl;
+}
+
+// Instancia de um arquivo de solucao: linha "Instancia:" ou, na falta dela,
+// o prefixo do nome do arquivo ate o primeiro '_'
+static string instanciaDoArquivo(const string &caminho, const string &nome) {
+  ifstream arquivo(caminho);
+  string linha;
+  if (getline(arquivo, linha) && linha.rfind("Instancia:", 0) == 0) {
+    size_t inicio = linha.find_first_not_of(' ', 10);
+    if (inicio != string::npos)
+      return linha.substr(inicio);
+  }
+  return nome.substr(0, nome.find('_'));
+}
+
+// Uma solucao a validar: um arquivo .txt ou um registro de .jsonl/.evrpsol
+struct ItemVerificacao {
+  string rotulo;
+  string caminho;
+  string instancia;
+  bool estruturado = false;
+  uint64_t hash = 0;
+  vector<vector<int>> rotas;
+  bool valido = false;
+  double custo = 0;
+  string motivo;
+};
+
+// Valida todas as solucoes de um diretorio em paralelo: .txt e cada
+// registro dos arquivos .jsonl/.evrpsol. Cada instancia e carregada uma vez
+// e compartilhada pelos seus arquivos.
+static int verificarTodos(const string &diretorio, int numThreads) {
+  vector<string> nomes;
+  DIR *dir = opendir(diretorio.c_str());
+  if (!dir) {
+    cerr << "Error: could not open " << diretorio << endl;
+    return 1;
+  }
+  while (dirent *entrada = readdir(dir)) {
+    string nome = entrada->d_name;
+    if ((nome.size() > 4 && nome.compare(nome.size() - 4, 4, ".txt") == 0) ||
+        arquivoSolucaoEstruturado(nome))
+      nomes.push_back(nome);
+  }
+  closedir(dir);
+  sort(nomes.begin(), nomes.end());
+
+  vector<ItemVerificacao> itens;
+  for (const string &nome : nomes) {
+    string caminho = diretorio + "/" + nome;
+    if (!arquivoSolucaoEstruturado(nome)) {
+      ItemVerificacao item;
+      item.rotulo = nome;
+      item.caminho = caminho;
+      item.instancia = instanciaDoArquivo(caminho, nome);
+      itens.push_back(move(item));
+      continue;
+    }
+    LeitorSolucoes leitor(caminho);
+    RegistroSolucao registro;
+    int k = 0;
+    while (leitor.proxima(registro)) {
+      ItemVerificacao item;
+      item.rotulo = nome + "#" + to_string(++k);
+      item.instancia = registro.instancia;
+      item.estruturado = true;
+      item.hash = registro.hashInstancia;
+      item.rotas = move(registro.rotas);
+      itens.push_back(move(item));
+    }
+    if (leitor.erro() || !leitor.aberto()) {
+      ItemVerificacao item;
+      item.rotulo = nome + "#" + to_string(k + 1);
+      item.motivo = "registro ilegivel";
+      itens.push_back(move(item));
+    }
+  }
+
+  // Sem matriz: so as distancias dos arcos das rotas sao calculadas
+  map<string, shared_ptr<const ContextoSolver>> contextos;
+  for (const auto &item : itens) {
+    if (!item.instancia.empty())
+      contextos[item.instancia];
+  }
+  vector<string> nomesInstancias;
+  for (auto &par : contextos)
+    nomesInstancias.push_back(par.first);
+  vector<shared_ptr<const ContextoSolver>> carregados(nomesInstancias.size());
+  executarParalelo(nomesInstancias.size(), numThreads, [&](int k) {
+    carregados[k] = carregarContexto(nomesInstancias[k], false, false);
+  });
+  for (size_t k = 0; k < nomesInstancias.size(); k++)
+    contextos[nomesInstancias[k]] = carregados[k];
+
+  executarParalelo(itens.size(), numThreads, [&](int k) {
+    ItemVerificacao &item = itens[k];
+    if (!item.motivo.empty())
+      return;
+    auto it = contextos.find(item.instancia);
+    if (it == contextos.end() || !it->second) {
+      item.motivo = "instancia " + item.instancia + " nao carregada";
+      return;
+    }
+    if (item.estruturado && item.hash != 0 &&
+        item.hash != it->second->hash) {
+      item.motivo = "hash da instancia diferente";
+      return;
+    }
+    if (!item.estruturado && !carregarSolucao(item.caminho, item.rotas)) {
+      item.motivo = "solucao ilegivel";
+      return;
+    }
+    item.valido = it->second->validar(item.rotas, false, &item.custo);
+  });
+
+  int validos = 0;
+  cout << fixed << setprecision(6);
+  for (const auto &item : itens) {
+    validos += item.valido;
+    cout << (item.valido ? "VALIDO   " : "INVALIDO ") << item.rotulo;
+    if (!item.motivo.empty())
+      cout << "  (" << item.motivo << ")";
+    else if (item.valido)
+      cout << "  " << item.custo;
+    cout << endl;
+  }
+  cout << "\n" << itens.size() << " solucoes: " << validos << " validas, "
+       << itens.size() - validos << " invalidas" << endl;
+  return validos == (int)itens.size() ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
   string nomeInstancia;
   string solver = "cplex";
+  string inicioMIP;
+  OpcoesLP opcoesLP;
+  bool todos = false;
+  string diretorio = "solucoes";
+  int numThreads = 0;
 
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--gurobi") == 0) {
       solver = "gurobi";
     } else if (strcmp(argv[i], "--cplex") == 0) {
       solver = "cplex";
+    } else if (strcmp(argv[i], "--all") == 0) {
+      todos = true;
+    } else if (strncmp(argv[i], "--dir=", 6) == 0) {
+      diretorio = argv[i] + 6;
+    } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+      numThreads = atoi(argv[i] + 10);
+    } else if (strncmp(argv[i], "--inicio-mip=", 13) == 0) {
+      inicioMIP = argv[i] + 13;
+    } else if (strcmp(argv[i], "--cortes") == 0) {
+      opcoesLP.cortes = true;
+    } else if (strcmp(argv[i], "--sem-eliminacao-arcos") == 0) {
+      opcoesLP.eliminarArcos = false;
     } else if (argv[i][0] != '-') {
       nomeInstancia = argv[i];
     } else {
       cerr << "Unknown option: " << argv[i] << endl;
-      cerr << "Usage: ./verify <instance_name> [--cplex|--gurobi]" << endl;
+      imprimirUso();
       return 1;
     }
   }
 
+  if (todos) {
+    return verificarTodos(diretorio, numThreads);
+  }
+
   if (nomeInstancia.empty()) {
     cerr << "Error: instance name is required" << endl;
-    cerr << "Usage: ./verify <instance_name> [--cplex|--gurobi]" << endl;
+    imprimirUso();
     cerr << "Example: ./verify E-n22-k4 --cplex" << endl;
     return 1;
   }
 
-  InstanciaEVRP instancia;
-
-  if (!carregarInstancia(nomeInstancia, instancia)) {
+  shared_ptr<const ContextoSolver> contexto =
+      carregarContexto(nomeInstancia, false, false);
+  if (!contexto) {
     cerr << "Error: could not load instance" << endl;
     return 1;
   }
+  const InstanciaEVRP &instancia = contexto->instancia;
+
+  // Inicio MIP: conferido contra o mesmo modelo que exportEVRPtoLP grava
+  if (!inicioMIP.empty()) {
+    ModeloMIP modelo;
+    construirModeloEVRP(instancia, opcoesLP, modelo);
+    vector<double> valores;
+    if (!lerInicioMIP(modelo, inicioMIP, valores)) {
+      cerr << "Error: could not read " << inicioMIP << endl;
+      return 1;
+    }
+    return verificarInicioMIP(modelo, valores) ? 0 : 1;
+  }
 
   bool valido = verificarSolucaoArquivo(instancia, nomeInstancia, solver);
   return valido ? 0 : 1;
-}
\ No newline at end of file
+}